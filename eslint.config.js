@@ -17,6 +17,7 @@ export default [
                 setInterval: 'readonly',
                 clearInterval: 'readonly',
                 setImmediate: 'readonly',
+                queueMicrotask: 'readonly',
                 clearImmediate: 'readonly',
                 performance: 'readonly',
                 URL: 'readonly',
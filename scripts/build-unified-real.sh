@@ -77,19 +77,29 @@ EXPORTED_FUNCTIONS='[
     "_connectNodes",
     "_connectToParam",
     "_disconnectNodes",
+    "_destroyNode",
+    "_releaseNode",
     "_startNode",
     "_stopNode",
     "_setNodeParameter",
     "_setNodeBuffer",
     "_registerBuffer",
     "_setNodeBufferId",
-    "_setNodeStringProperty",
+    "_releaseBuffer",
     "_setWaveShaperCurve",
-    "_setWaveShaperOversample",
     "_setNodePeriodicWave",
     "_setNodeProperty",
     "_scheduleParamEvent",
+    "_scheduleParamCurve",
+    "_applyCommands",
     "_processGraph",
+    "_takeRenderStats",
+    "_setGraphProfiling",
+    "_getGraphProfile",
+    "_setGraphTracing",
+    "_takeGraphTrace",
+    "_renderGraphRange",
+    "_renderGraphRangePlanar",
     "_deinterleaveAudio",
     "_getGraphCurrentTime",
     "_setGraphCurrentTime",
@@ -112,7 +122,7 @@ EXPORTED_FUNCTIONS='[
     "_free"
 ]'
 
-EXPORTED_RUNTIME_METHODS='["ccall", "cwrap", "HEAPU8", "HEAPU32", "HEAP32", "HEAPF32", "stringToUTF8", "lengthBytesUTF8"]'
+EXPORTED_RUNTIME_METHODS='["ccall", "cwrap", "addFunction", "removeFunction", "HEAPU8", "HEAPU32", "HEAP32", "HEAPF32", "HEAPF64", "stringToUTF8", "lengthBytesUTF8"]'
 
 echo "Compiling unified WASM: graph + all nodes + decoders..."
 echo "This may take a minute due to audio decoder libraries..."
@@ -166,6 +176,7 @@ em++ $CXXFLAGS $INCLUDES \
     -s EXPORTED_FUNCTIONS="$EXPORTED_FUNCTIONS" \
     -s EXPORTED_RUNTIME_METHODS="$EXPORTED_RUNTIME_METHODS" \
     -s ALLOW_MEMORY_GROWTH=1 \
+    -s ALLOW_TABLE_GROWTH=1 \
     -s INITIAL_MEMORY=268435456 \
     -s MAXIMUM_MEMORY=4294967296 \
     -s MODULARIZE=1 \
@@ -19,6 +19,14 @@ export class AudioBuffer {
         // _ensureChannels().
         this._buffer = null;
         this._channels = null;
+
+        // Bumped whenever the samples change, so engines holding an older copy
+        // register it again (_registerWith) and the interleaved buffer is
+        // rebuilt from the channel views (_getInterleavedData). Writes through
+        // views from getChannelData() are only found by _checkViews().
+        this._version = 0;
+        this._interleavedVersion = 0;
+        this._viewsHandedOut = false;
     }
 
     // Allocate + fill the de-interleaved per-channel arrays on demand. Cheap to
@@ -59,6 +67,16 @@ export class AudioBuffer {
     // entirely. _channels stay lazy.
     _setInterleavedBuffer(interleaved) {
         this._buffer = interleaved;
+        this._interleavedVersion = ++this._version;
+    }
+
+    // Fast path for offline renders: adopt one Float32Array per channel as the
+    // channel data directly. The interleaved buffer is only built if something
+    // asks for it.
+    _setChannels(channels) {
+        this._channels = channels;
+        this._buffer = null;
+        this._version++;
     }
 
     getChannelData(channel) {
@@ -66,6 +84,8 @@ export class AudioBuffer {
             throw new Error('Invalid channel index');
         }
         this._ensureChannels();
+        // The caller may write through the view; _checkViews() looks
+        this._viewsHandedOut = true;
         return this._channels[channel];
     }
 
@@ -94,6 +114,7 @@ export class AudioBuffer {
             channel[startInChannel + i] = source[i];
         }
 
+        this._version++;
         this._updateInternalBuffer();
     }
 
@@ -112,15 +133,61 @@ export class AudioBuffer {
                 this._buffer[frame * this.numberOfChannels + ch] = this._channels[ch][frame];
             }
         }
+        this._interleavedVersion = this._version;
+    }
+
+    // Bump the version if the channel views from getChannelData() were written
+    // since the interleaved buffer was built from (or decoded alongside) them.
+    // A read-only compare, so reading samples never costs a re-copy.
+    _checkViews() {
+        if (!this._viewsHandedOut || !this._buffer || this._interleavedVersion !== this._version) {
+            return;
+        }
+        const n = this.numberOfChannels;
+        for (let ch = 0; ch < n; ch++) {
+            const channel = this._channels[ch];
+            for (let frame = 0; frame < this.length; frame++) {
+                const a = channel[frame];
+                const b = this._buffer[frame * n + ch];
+                if (a !== b && !(a !== a && b !== b)) {
+                    this._version++;
+                    return;
+                }
+            }
+        }
+    }
+
+    // Write the PCM into the context's sample store: once, and again only if
+    // the samples have changed since. Buffer sources and convolvers then refer
+    // to it by _id, and the store lets go of it when this buffer is garbage
+    // collected.
+    _registerWith(context) {
+        this._checkViews();
+        const engine = context._engine;
+        const registered = engine._registeredBuffers.get(this._id);
+        if (registered !== this._version) {
+            engine.registerBuffer(
+                this._id,
+                this._getInterleavedData(),
+                this.length,
+                this.numberOfChannels,
+                this.sampleRate
+            );
+            if (registered === undefined) engine.trackBuffer(this, this._id);
+            engine._registeredBuffers.set(this._id, this._version);
+        }
+        return this._id;
     }
 
     _getInterleavedData() {
         // Fast path: a decoder already handed us the interleaved buffer — return it
         // as-is (no per-sample loop). Otherwise build it from the channel views.
         if (this._buffer && !this._channels) return this._buffer;
-        if (!this._buffer) {
-            // No interleaved buffer yet: either channels were written, or this is an
-            // empty buffer. Materialize channels (empty) then interleave.
+        this._checkViews();
+        if (!this._buffer || this._interleavedVersion !== this._version) {
+            // No interleaved buffer yet (channels were written, or this is an
+            // empty buffer: materialize empty channels), or the channel views
+            // have been written since it was built. Interleave them.
             this._ensureChannels();
             this._updateInternalBuffer();
         }
@@ -7,6 +7,8 @@ export class AudioNode {
         this.channelCount = 2;
         this.channelCountMode = 'explicit';
         this.channelInterpretation = 'speakers';
+
+        context._engine.trackNode(this, nodeId);
     }
 
     connect(destination, outputIndex = 0, inputIndex = 0) {
@@ -75,14 +75,14 @@ export class AudioParam {
             throw new RangeError('setValueCurveAtTime: duration must be positive');
         }
 
-        // Convert to regular array if it's a Float32Array
-        const valuesArray = Array.isArray(values) ? values : Array.from(values);
+        // Copied now: changing the caller's array later must not affect the curve
+        const curve = Float32Array.from(values);
 
         this.context._engine.scheduleParameterValue(
             this._nodeId,
             this._paramName,
             'setValueCurveAtTime',
-            valuesArray,
+            curve,
             startTime,
             duration
         );
@@ -1,6 +1,11 @@
 import { AudioNode } from '../AudioNode.js';
 import { AudioParam } from '../AudioParam.js';
 
+// Resampling used when playbackRate/detune move the playhead between buffer
+// frames (a non-standard extension): linear as in browsers, cubic
+// (Catmull-Rom), or a 16-tap windowed sinc
+const INTERPOLATION_TYPES = ['linear', 'cubic', 'sinc'];
+
 export class AudioBufferSourceNode extends AudioNode {
     constructor(context, options = {}) {
         const nodeId = context._engine.createNode('bufferSource', options);
@@ -14,6 +19,7 @@ export class AudioBufferSourceNode extends AudioNode {
             loop = false,
             loopStart = 0,
             loopEnd = 0,
+            interpolation = 'linear',
             channelCount,
             channelCountMode,
             channelInterpretation
@@ -32,6 +38,7 @@ export class AudioBufferSourceNode extends AudioNode {
         this.loop = loop;
         this.loopStart = loopStart;
         this.loopEnd = loopEnd;
+        this.interpolation = interpolation;
         this.onended = null;
 
         this._started = false;
@@ -43,6 +50,47 @@ export class AudioBufferSourceNode extends AudioNode {
         if (channelInterpretation !== undefined) this.channelInterpretation = channelInterpretation;
     }
 
+    // Loop attributes reach the engine as soon as they are set, so a playing
+    // source picks up loop changes
+    get loop() {
+        return this._loop;
+    }
+
+    set loop(value) {
+        this._loop = Boolean(value);
+        this.context._engine.setNodeParameter(this._nodeId, 'loop', this._loop ? 1.0 : 0.0);
+    }
+
+    get loopStart() {
+        return this._loopStart;
+    }
+
+    set loopStart(value) {
+        this._loopStart = value;
+        this.context._engine.setNodeParameter(this._nodeId, 'loopStart', value);
+    }
+
+    get loopEnd() {
+        return this._loopEnd;
+    }
+
+    set loopEnd(value) {
+        this._loopEnd = value;
+        this.context._engine.setNodeParameter(this._nodeId, 'loopEnd', value);
+    }
+
+    get interpolation() {
+        return this._interpolation;
+    }
+
+    set interpolation(value) {
+        if (!INTERPOLATION_TYPES.includes(value)) {
+            throw new TypeError('interpolation must be "linear", "cubic", or "sinc"');
+        }
+        this._interpolation = value;
+        this.context._engine.setNodeStringProperty(this._nodeId, 'interpolation', value);
+    }
+
     start(when = 0, offset = 0, duration) {
         if (this._started) {
             throw new Error('Cannot call start more than once');
@@ -69,27 +117,9 @@ export class AudioBufferSourceNode extends AudioNode {
 
         this._started = true;
 
-        // Register buffer with engine if not already registered
-        if (!this.context._registeredBuffers) {
-            this.context._registeredBuffers = new Set();
-        }
-
-        const registeredBufferKey = `${this.buffer._id}:${this.context.sampleRate}`;
-
-        if (!this.context._registeredBuffers.has(registeredBufferKey)) {
-            const bufferData = this.buffer._getInterleavedData();
-            this.context._engine.registerBuffer(
-                this.buffer._id,
-                bufferData,
-                this.buffer.length,
-                this.buffer.numberOfChannels,
-                this.buffer.sampleRate
-            );
-            this.context._registeredBuffers.add(registeredBufferKey);
-        }
-
-        // Set buffer ID (not data) in native code
-        this.context._engine.setNodeBufferId(this._nodeId, this.buffer._id);
+        // Register the buffer's PCM with the engine (once per context) and
+        // point the node at it by ID
+        this.context._engine.setNodeBufferId(this._nodeId, this.buffer._registerWith(this.context));
 
         // Set playback offset and duration
         if (offset !== 0) {
@@ -99,11 +129,6 @@ export class AudioBufferSourceNode extends AudioNode {
             this.context._engine.setNodeParameter(this._nodeId, 'playbackDuration', duration);
         }
 
-        // Set loop parameters
-        this.context._engine.setNodeParameter(this._nodeId, 'loop', this.loop ? 1.0 : 0.0);
-        this.context._engine.setNodeParameter(this._nodeId, 'loopStart', this.loopStart);
-        this.context._engine.setNodeParameter(this._nodeId, 'loopEnd', this.loopEnd);
-
         // Start node
         this.context._engine.startNode(this._nodeId, when);
 
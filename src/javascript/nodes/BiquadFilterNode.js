@@ -30,7 +30,7 @@ export class BiquadFilterNode extends AudioNode {
         this.gain = new AudioParam(context, nodeId, 'gain', gainValue, -40.0, 40.0);
         this.detune = new AudioParam(context, nodeId, 'detune', det, -1200, 1200);
 
-        this._type = type;
+        this.type = type;
 
         // Apply channel config from options
         if (options.channelCount !== undefined) this.channelCount = options.channelCount;
@@ -59,8 +59,7 @@ export class BiquadFilterNode extends AudioNode {
             throw new Error(`Invalid filter type: ${value}`);
         }
         this._type = value;
-        // Type is set during creation, would need to recreate node to change it
-        // For now, just store it
+        this.context._engine.setNodeProperty(this._nodeId, 'type', validTypes.indexOf(value));
     }
 
     getFrequencyResponse(_frequencyHz, _magResponse, _phaseResponse) {
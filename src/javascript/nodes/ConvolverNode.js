@@ -33,21 +33,10 @@ export class ConvolverNode extends AudioNode {
 
         this._buffer = value;
 
-        // Prepare interleaved buffer data for native code
-        const length = value.length;
-        const numberOfChannels = value.numberOfChannels;
-        const interleavedData = new Float32Array(length * numberOfChannels);
-
-        // Interleave channel data
-        for (let channel = 0; channel < numberOfChannels; channel++) {
-            const channelData = value.getChannelData(channel);
-            for (let i = 0; i < length; i++) {
-                interleavedData[i * numberOfChannels + channel] = channelData[i];
-            }
-        }
-
-        // Send to native code
-        this.context._engine.setNodeBuffer(this._nodeId, interleavedData, length, numberOfChannels);
+        // The impulse response is built from the buffer's PCM in the engine's
+        // sample store, shared with any buffer source playing the same buffer
+        // (and registered again if the buffer was written since)
+        this.context._engine.setNodeBufferId(this._nodeId, value._registerWith(this.context));
     }
 
     get normalize() {
@@ -30,7 +30,7 @@ export class OscillatorNode extends AudioNode {
         );
         this.detune = new AudioParam(context, nodeId, 'detune', detune, -4800.0, 4800.0);
 
-        // Go through the setter so setNodeParameter pushes the type to the engine.
+        // Go through the setter so setNodeProperty pushes the type to the engine.
         // createNode ignores the type option and defaults the C oscillator, so a
         // plain `new OscillatorNode({type:'sine'})` would otherwise stay the C
         // default instead of the requested waveform.
@@ -60,7 +60,7 @@ export class OscillatorNode extends AudioNode {
             throw new Error(`Invalid oscillator type: ${value}`);
         }
         this._type = value;
-        this.context._engine.setNodeParameter(this._nodeId, 'type', validTypes.indexOf(value));
+        this.context._engine.setNodeProperty(this._nodeId, 'type', validTypes.indexOf(value));
     }
 
     start(when = 0) {
@@ -108,11 +108,16 @@ export class OscillatorNode extends AudioNode {
     }
 
     setPeriodicWave(periodicWave) {
-        if (!periodicWave || !periodicWave.wavetable) {
+        if (!periodicWave || !periodicWave.real || !periodicWave.imag) {
             throw new TypeError('setPeriodicWave requires a PeriodicWave object');
         }
 
         this._type = 'custom';
-        this.context._engine.setNodePeriodicWave(this._nodeId, periodicWave.wavetable);
+        this.context._engine.setNodePeriodicWave(
+            this._nodeId,
+            periodicWave.real,
+            periodicWave.imag,
+            periodicWave.disableNormalization
+        );
     }
 }
@@ -0,0 +1,69 @@
+// AudioContext.renderCapacity: how close the real-time renderer runs to its
+// deadline, reported every updateInterval seconds through onupdate.
+//
+// Load is the time spent in processGraph (timed natively with a monotonic
+// clock) divided by the audio time it produced: 0.5 means half of the
+// real-time budget went to rendering. Underruns are counted by the context's
+// SDL feeder when it finds the queue empty.
+
+export class AudioRenderCapacity {
+    constructor(context) {
+        this._context = context;
+        this._timer = null;
+        this._lastUnderruns = 0;
+        this._lastTicks = 0;
+
+        // Called with { target, timestamp, averageLoad, peakLoad,
+        // underrunRatio, underruns, queueDepth, renderTime }
+        this.onupdate = null;
+    }
+
+    start(options = {}) {
+        const updateInterval = options.updateInterval ?? 1;
+        if (!(updateInterval > 0)) {
+            throw new RangeError(`updateInterval must be positive, got ${updateInterval}`);
+        }
+
+        this.stop();
+
+        // Start a fresh period: drop what was gathered before start()
+        const latency = this._context._latency;
+        this._lastUnderruns = latency.underruns;
+        this._lastTicks = latency.ticks;
+        this._context._engine.takeRenderStats();
+
+        this._timer = setInterval(() => this._update(), updateInterval * 1000);
+        this._timer.unref();
+    }
+
+    stop() {
+        if (this._timer) {
+            clearInterval(this._timer);
+            this._timer = null;
+        }
+    }
+
+    async _update() {
+        const context = this._context;
+        const stats = await context._engine.takeRenderStats();
+        if (!stats || !this._timer || !this.onupdate) return;
+
+        const latency = context._latency;
+        const underruns = latency.underruns - this._lastUnderruns;
+        const ticks = latency.ticks - this._lastTicks;
+        this._lastUnderruns = latency.underruns;
+        this._lastTicks = latency.ticks;
+
+        const device = context._audioDevice;
+        this.onupdate({
+            target: this,
+            timestamp: context.currentTime,
+            averageLoad: stats.audioMs > 0 ? stats.renderMs / stats.audioMs : 0,
+            peakLoad: stats.peakLoad,
+            underrunRatio: ticks > 0 ? underruns / ticks : 0,
+            underruns: latency.underruns,
+            queueDepth: device ? device.queued / (context.sampleRate * context._channels * 4) : 0,
+            renderTime: stats.renderMs / 1000
+        });
+    }
+}
@@ -0,0 +1,153 @@
+// Graph mutations batched in WASM memory for applyCommands
+//
+// Param and property changes, scheduling, connections and releases are the
+// bulk of what a scene update sends to the graph. Instead of one WASM call
+// each, they are written here with a DataView and applied in order by a single
+// applyCommands(graph_id, ptr, len) call (see GraphCommand in
+// audio_graph_simple.cpp for the layout), at the latest right before the next
+// render.
+
+// Opcodes - match C++ GraphCommand
+const CMD_SET_PARAM = 1;
+const CMD_SCHEDULE_PARAM = 2;
+const CMD_START = 3;
+const CMD_STOP = 4;
+const CMD_CONNECT = 5;
+const CMD_DISCONNECT = 6;
+const CMD_RELEASE = 7;
+const CMD_DESTROY = 8;
+const CMD_SET_BUFFER_ID = 9;
+const CMD_SET_PROPERTY = 10;
+const CMD_CONNECT_PARAM = 11;
+const CMD_DISCONNECT_PARAM = 12;
+
+// Largest command: schedule-param, opcode + 32 bytes of fields
+const MAX_COMMAND_BYTES = 36;
+
+export class CommandBuffer {
+    // `flush` applies what has been written so far; it is called when the
+    // buffer fills up.
+    constructor(wasmModule, flush, capacity = 64 * 1024) {
+        this.wasmModule = wasmModule;
+        this._flush = flush;
+        this.capacity = capacity;
+        this.ptr = wasmModule._malloc(capacity);
+        this.length = 0;
+        this._view = null;
+    }
+
+    // Room for one more command. The DataView is re-created after the WASM
+    // heap grows (the old ArrayBuffer is detached then).
+    _begin(op) {
+        if (this.length + MAX_COMMAND_BYTES > this.capacity) this._flush();
+        const buffer = this.wasmModule.HEAPU8.buffer;
+        if (!this._view || this._view.buffer !== buffer) {
+            this._view = new DataView(buffer, this.ptr, this.capacity);
+        }
+        this._view.setUint32(this.length, op, true);
+        this.length += 4;
+        return this._view;
+    }
+
+    _i32(view, value) {
+        view.setInt32(this.length, value, true);
+        this.length += 4;
+    }
+
+    _f32(view, value) {
+        view.setFloat32(this.length, value, true);
+        this.length += 4;
+    }
+
+    _f64(view, value) {
+        view.setFloat64(this.length, value, true);
+        this.length += 8;
+    }
+
+    setParam(nodeId, paramId, value) {
+        const view = this._begin(CMD_SET_PARAM);
+        this._i32(view, nodeId);
+        this._i32(view, paramId);
+        this._f32(view, value);
+    }
+
+    scheduleParam(nodeId, paramId, kind, value, time, timeConstant) {
+        const view = this._begin(CMD_SCHEDULE_PARAM);
+        this._i32(view, nodeId);
+        this._i32(view, paramId);
+        this._i32(view, kind);
+        this._f32(view, value);
+        this._f64(view, time);
+        this._f32(view, timeConstant);
+    }
+
+    start(nodeId, when) {
+        const view = this._begin(CMD_START);
+        this._i32(view, nodeId);
+        this._f64(view, when);
+    }
+
+    stop(nodeId, when) {
+        const view = this._begin(CMD_STOP);
+        this._i32(view, nodeId);
+        this._f64(view, when);
+    }
+
+    connect(sourceId, destId, output, input) {
+        const view = this._begin(CMD_CONNECT);
+        this._i32(view, sourceId);
+        this._i32(view, destId);
+        this._i32(view, output);
+        this._i32(view, input);
+    }
+
+    connectParam(sourceId, destId, paramId, output) {
+        const view = this._begin(CMD_CONNECT_PARAM);
+        this._i32(view, sourceId);
+        this._i32(view, destId);
+        this._i32(view, paramId);
+        this._i32(view, output);
+    }
+
+    disconnectParam(sourceId, destId, paramId) {
+        const view = this._begin(CMD_DISCONNECT_PARAM);
+        this._i32(view, sourceId);
+        this._i32(view, destId);
+        this._i32(view, paramId);
+    }
+
+    disconnect(sourceId, destId) {
+        const view = this._begin(CMD_DISCONNECT);
+        this._i32(view, sourceId);
+        this._i32(view, destId);
+    }
+
+    release(nodeId) {
+        const view = this._begin(CMD_RELEASE);
+        this._i32(view, nodeId);
+    }
+
+    destroy(nodeId) {
+        const view = this._begin(CMD_DESTROY);
+        this._i32(view, nodeId);
+    }
+
+    setBufferId(nodeId, bufferId) {
+        const view = this._begin(CMD_SET_BUFFER_ID);
+        this._i32(view, nodeId);
+        this._i32(view, bufferId);
+    }
+
+    setProperty(nodeId, propertyId, value) {
+        const view = this._begin(CMD_SET_PROPERTY);
+        this._i32(view, nodeId);
+        this._i32(view, propertyId);
+        this._f32(view, value);
+    }
+
+    free() {
+        if (this.ptr) this.wasmModule._free(this.ptr);
+        this.ptr = 0;
+        this.length = 0;
+    }
+}
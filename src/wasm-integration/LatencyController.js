@@ -0,0 +1,108 @@
+// Adaptive output latency for WasmAudioContext
+//
+// The real-time context keeps rendered audio queued in SDL ahead of the
+// device. How much it keeps queued is the context's latency: too little and
+// a late render tick underruns, too much and every sound is late. The
+// controller starts from the latencyHint's target, shrinks it step by step
+// while playback stays clean and grows it quickly after an underrun.
+//
+// A stall tolerance keeps the queue that much deeper than the target, for
+// when the thread feeding it may stall (a render worker still relies on the
+// main thread to move its audio into SDL).
+
+// Queue depth in seconds per latencyHint: where to start and the range the
+// controller may move in.
+const LATENCY_PROFILES = {
+    interactive: { target: 0.03, min: 0.015, max: 0.2 },
+    balanced: { target: 0.08, min: 0.04, max: 0.3 },
+    playback: { target: 0.2, min: 0.2, max: 0.5 }
+};
+
+// Shrink one step per this many ms without an underrun
+const SHRINK_INTERVAL_MS = 2000;
+const SHRINK_FACTOR = 0.85;
+const GROW_FACTOR = 1.5;
+
+export class LatencyController {
+    constructor(latencyHint = 'interactive', sampleRate = 44100, stallTolerance = 0) {
+        if (!Number.isFinite(stallTolerance) || stallTolerance < 0) {
+            throw new TypeError(
+                `stallTolerance must be a non-negative number, got ${stallTolerance}`
+            );
+        }
+
+        let profile;
+        if (typeof latencyHint === 'number') {
+            if (!Number.isFinite(latencyHint) || latencyHint < 0) {
+                throw new TypeError(
+                    `latencyHint must be a non-negative number, got ${latencyHint}`
+                );
+            }
+            // A number is the latency asked for: start there, allow shrinking
+            // to half of it and growing as far as the playback profile.
+            const target = Math.max(latencyHint, 0.005);
+            profile = { target, min: target / 2, max: Math.max(target * 4, 0.2) };
+        } else {
+            profile = LATENCY_PROFILES[latencyHint];
+            if (!profile) {
+                throw new TypeError(
+                    `latencyHint must be 'interactive', 'balanced', 'playback' or a number, got '${latencyHint}'`
+                );
+            }
+        }
+
+        this.sampleRate = sampleRate;
+        this.min = profile.min;
+        this.max = profile.max;
+        this.target = profile.target;
+        this.stallTolerance = stallTolerance;
+        this.underruns = 0;
+        this.ticks = 0; // feeder ticks seen, the denominator of an underrun ratio
+        this._lastChange = 0;
+    }
+
+    // SDL device buffer (frames, a power of 2): the latency the driver adds on
+    // top of the queue. Kept to about half the smallest queue depth so the
+    // device never asks for more than the queue can hold.
+    get deviceFrames() {
+        const frames = (this.min * this.sampleRate) / 2;
+        return Math.max(64, 2 ** Math.floor(Math.log2(Math.max(frames, 1))));
+    }
+
+    // Seconds the queue is kept at: the target plus the stall tolerance
+    get queueTarget() {
+        return this.target + this.stallTolerance;
+    }
+
+    // Frames to render now so the queue is back at queueTarget; rounded up to
+    // whole 128-frame quanta.
+    framesToQueue(queuedSeconds) {
+        const missing = this.queueTarget - queuedSeconds;
+        if (missing <= 0) return 0;
+        return Math.ceil((missing * this.sampleRate) / 128) * 128;
+    }
+
+    // Feeder tick interval: a few ticks per target period, never above 10ms
+    get tickMs() {
+        return Math.max(1, Math.min(10, Math.floor((this.target * 1000) / 4)));
+    }
+
+    // Report one feeder tick. `queuedSeconds` is the queue depth seen before
+    // refilling; an empty queue while playing means the device ran dry.
+    update(queuedSeconds, now = Date.now()) {
+        this.ticks++;
+        if (queuedSeconds <= 0) {
+            this.underruns++;
+            this.target = Math.min(this.max, this.target * GROW_FACTOR);
+            this._lastChange = now;
+        } else if (now - this._lastChange >= SHRINK_INTERVAL_MS) {
+            this.target = Math.max(this.min, this.target * SHRINK_FACTOR);
+            this._lastChange = now;
+        }
+    }
+
+    // Start the shrink timer over (e.g. on resume), without counting an underrun
+    reset(now = Date.now()) {
+        this._lastChange = now;
+    }
+}
@@ -0,0 +1,285 @@
+// Off-main-thread rendering for WasmAudioContext ({ renderThread: 'worker' })
+//
+// The WASM graph lives in a worker thread (RenderWorker.js), which renders
+// ahead into a single-producer/single-consumer ring in a SharedArrayBuffer. The
+// main thread only moves rendered audio from the ring into the SDL queue, so a
+// GC pause or a long stretch of JS work no longer stops audio from being
+// rendered. Graph edits made on the main thread are queued as commands and
+// posted to the worker, which applies them between render chunks.
+
+import { Worker } from 'worker_threads';
+import { wasmModule as defaultWasmModule } from './WasmModule.js';
+
+// Ring layout in the SharedArrayBuffer. Positions count samples (not frames)
+// and wrap at the capacity; one sample is always left free so that
+// write === read means empty, as in src/wasm/utils/RingBuffer.h.
+export const RING_WRITE = 0; // Int32 slot: producer (worker) position
+export const RING_READ = 1; // Int32 slot: consumer (main thread) position
+export const RING_STOP = 2; // Int32 slot: set to 1 to stop the worker
+export const RING_DEPTH = 3; // Int32 slot: samples the worker keeps rendered ahead
+const RING_HEADER_BYTES = 16;
+const RING_TIME_BYTES = 8; // BigInt64: graph time after the last render, in frames
+export const RING_DATA_OFFSET = RING_HEADER_BYTES + RING_TIME_BYTES;
+
+// WasmAudioEngine methods that are forwarded to the worker, with the argument
+// positions that hold node ids. The main thread hands out its own ids (it
+// can't wait for the worker to create the node), and the worker maps them to
+// graph handles before making the call.
+export const FORWARDED_METHODS = {
+    releaseNode: [0],
+    destroyNode: [0],
+    connectNodes: [0, 1],
+    connectToParam: [0, 1],
+    disconnectNodes: [0, 1],
+    disconnectNode: [0],
+    disconnectOutput: [0],
+    disconnectFromParam: [0, 1],
+    setNodeParameter: [0],
+    setNodeBuffer: [0],
+    setIIRFilterCoefficients: [0],
+    scheduleParameterValue: [0],
+    startNode: [0],
+    stopNode: [0],
+    registerBuffer: [],
+    releaseBuffer: [],
+    setNodeBufferId: [0],
+    setWaveShaperCurve: [0],
+    clearWaveShaperCurve: [0],
+    setNodePeriodicWave: [0],
+    setWaveShaperOversample: [0],
+    setNodeProperty: [0],
+    setNodeStringProperty: [0],
+    setAnalyserFFTSize: [0],
+    setAnalyserMinDecibels: [0],
+    setAnalyserMaxDecibels: [0],
+    setAnalyserSmoothingTimeConstant: [0],
+    setCurrentTime: [],
+    setProfiling: [],
+    setTracing: []
+};
+
+// Stands in for WasmAudioEngine on the main thread when rendering happens in a
+// worker: same methods, but graph edits become commands for the worker.
+export class WorkerRenderEngine {
+    // The ring holds up to ringSeconds; the worker keeps depthSeconds of it
+    // filled (see setRingDepth).
+    constructor(numberOfChannels, sampleRate, ringSeconds = 0.5, depthSeconds = ringSeconds) {
+        this.numberOfChannels = numberOfChannels;
+        this.sampleRate = sampleRate;
+        this.isWorker = true;
+
+        // Decoding and AudioBuffer helpers still run on this thread's module;
+        // there is no graph on this side.
+        this.wasmModule = defaultWasmModule;
+        this.graphId = null;
+
+        // Capacity in samples, a whole number of frames
+        this._capacity = Math.ceil(sampleRate * ringSeconds) * numberOfChannels;
+        this._sab = new SharedArrayBuffer(RING_DATA_OFFSET + this._capacity * 4);
+        this._header = new Int32Array(this._sab, 0, RING_HEADER_BYTES / 4);
+        this._time = new BigInt64Array(this._sab, RING_HEADER_BYTES, 1);
+        this.setRingDepth(depthSeconds);
+
+        this._worker = new Worker(new URL('./RenderWorker.js', import.meta.url), {
+            workerData: {
+                sab: this._sab,
+                capacity: this._capacity,
+                numberOfChannels,
+                sampleRate
+            }
+        });
+        // The feeder loop keeps the process alive while playing; an idle
+        // context shouldn't.
+        this._worker.unref();
+
+        // Queries answered by the worker (see REQUESTS in RenderWorker.js),
+        // by request id
+        this._requests = new Map();
+        this._nextRequestId = 1;
+
+        // Resolved once the worker has started and filled the ring; rejected
+        // if the worker dies first (e.g. the WASM module failed to load).
+        this._primed = new Promise((resolve, reject) => {
+            this._worker.on('message', message => {
+                if (message === 'primed') {
+                    resolve();
+                } else if (message.reply !== undefined) {
+                    this._requests.get(message.reply)?.(message.value);
+                    this._requests.delete(message.reply);
+                }
+            });
+            this._worker.on('error', error => {
+                console.error('[WasmAudioContext] Render worker failed:', error);
+                reject(error);
+            });
+        });
+        this._primed.catch(() => {});
+        this._started = false;
+
+        this._nextNodeId = 1;
+        this._pending = [];
+        this._flushScheduled = false;
+
+        this._nodeRegistry =
+            typeof FinalizationRegistry === 'function'
+                ? new FinalizationRegistry(nodeId => this.releaseNode(nodeId))
+                : null;
+        this._registeredBuffers = new Map(); // as in WasmAudioEngine
+        this._bufferRegistry =
+            typeof FinalizationRegistry === 'function'
+                ? new FinalizationRegistry(bufferId => this.releaseBuffer(bufferId))
+                : null;
+    }
+
+    // Commands made in one synchronous stretch of JS go to the worker as one
+    // message, in order.
+    _post(method, args) {
+        this._pending.push([method, args]);
+        if (!this._flushScheduled) {
+            this._flushScheduled = true;
+            queueMicrotask(() => this._flush());
+        }
+    }
+
+    _flush() {
+        this._flushScheduled = false;
+        if (this._pending.length === 0 || !this._worker) return;
+        this._worker.postMessage({ commands: this._pending });
+        this._pending = [];
+    }
+
+    createNode(type, _options = {}) {
+        const nodeId = this._nextNodeId++;
+        this._post('createNode', [nodeId, type]);
+        return nodeId;
+    }
+
+    trackNode(node, nodeId) {
+        if (this._nodeRegistry && nodeId) this._nodeRegistry.register(node, nodeId);
+    }
+
+    trackBuffer(buffer, bufferId) {
+        if (this._bufferRegistry) this._bufferRegistry.register(buffer, bufferId);
+    }
+
+    releaseBuffer(bufferId) {
+        this._registeredBuffers.delete(bufferId);
+        this._post('releaseBuffer', [bufferId]);
+    }
+
+    // Analysers can't be read synchronously across threads; like the
+    // main-thread engine these leave the array untouched for now.
+    getFloatFrequencyData(_nodeId, _array) {}
+    getByteFrequencyData(_nodeId, _array) {}
+    getFloatTimeDomainData(_nodeId, _array) {}
+    getByteTimeDomainData(_nodeId, _array) {}
+
+    // Graph time as of the worker's last render, published through the ring
+    getCurrentTime() {
+        return Number(Atomics.load(this._time, 0)) / this.sampleRate;
+    }
+
+    // Ask the worker for something only the graph knows. Commands queued so
+    // far are applied first. Resolves to null if the worker is gone.
+    _request(name) {
+        if (!this._worker) return null;
+        this._flush();
+        const id = this._nextRequestId++;
+        return new Promise(resolve => {
+            this._requests.set(id, resolve);
+            this._worker.postMessage({ request: name, id });
+        });
+    }
+
+    // Render timing, profile and trace are gathered where processGraph runs,
+    // in the worker, so these answer with a promise (node ids already
+    // translated back to this thread's).
+    takeRenderStats() {
+        return this._request('takeRenderStats');
+    }
+
+    getGraphProfile() {
+        return this._request('getGraphProfile');
+    }
+
+    takeTrace() {
+        return this._request('takeTrace');
+    }
+
+    // Main-thread node ids the worker still maps to graph handles
+    mappedNodeIds() {
+        return this._request('mappedNodeIds');
+    }
+
+    // How far ahead the worker renders. Audio in the ring is already rendered,
+    // so graph edits are heard this much later (plus the device queue); keep
+    // it at the latency target rather than the ring's capacity.
+    setRingDepth(seconds) {
+        const frames = Math.max(1, Math.round(seconds * this.sampleRate));
+        const depth = Math.min(this._capacity - 1, frames * this.numberOfChannels);
+        if (Atomics.exchange(this._header, RING_DEPTH, depth) < depth) {
+            // Deeper than before: wake the worker if it is waiting for space
+            Atomics.notify(this._header, RING_READ);
+        }
+    }
+
+    // Frames rendered and waiting in the ring
+    get bufferedFrames() {
+        const read = Atomics.load(this._header, RING_READ);
+        const write = Atomics.load(this._header, RING_WRITE);
+        return ((write - read + this._capacity) % this._capacity) / this.numberOfChannels;
+    }
+
+    // Start rendering (on the first resume) and wait until the ring is filled
+    // to its depth, so playback starts with that much headroom.
+    start() {
+        if (!this._started) {
+            this._started = true;
+            this._flush();
+            this._worker.postMessage({ start: true });
+        }
+        return this._primed;
+    }
+
+    // Move up to maxFrames of rendered audio from the ring to the SDL device.
+    // Enqueues Buffer views over the shared ring (SDL copies them), then
+    // hands the space back to the worker. Returns the frames enqueued.
+    enqueueRendered(device, maxFrames) {
+        const capacity = this._capacity;
+        const read = Atomics.load(this._header, RING_READ);
+        const write = Atomics.load(this._header, RING_WRITE);
+        const available = Math.min(
+            (write - read + capacity) % capacity,
+            maxFrames * this.numberOfChannels
+        );
+        if (available === 0) return 0;
+
+        const first = Math.min(available, capacity - read);
+        device.enqueue(Buffer.from(this._sab, RING_DATA_OFFSET + read * 4, first * 4));
+        if (available > first) {
+            device.enqueue(Buffer.from(this._sab, RING_DATA_OFFSET, (available - first) * 4));
+        }
+
+        Atomics.store(this._header, RING_READ, (read + available) % capacity);
+        Atomics.notify(this._header, RING_READ);
+        return available / this.numberOfChannels;
+    }
+
+    destroy() {
+        if (!this._worker) return;
+        Atomics.store(this._header, RING_STOP, 1);
+        Atomics.notify(this._header, RING_READ);
+        this._worker.terminate();
+        this._worker = null;
+        for (const resolve of this._requests.values()) resolve(null);
+        this._requests.clear();
+    }
+}
+
+// Plain forwarding for the methods without anything to do on this side
+for (const method of Object.keys(FORWARDED_METHODS)) {
+    if (Object.hasOwn(WorkerRenderEngine.prototype, method)) continue;
+    WorkerRenderEngine.prototype[method] = function (...args) {
+        this._post(method, args);
+    };
+}
@@ -0,0 +1,141 @@
+// Render worker for WasmAudioContext ({ renderThread: 'worker' })
+//
+// Owns the context's WASM graph. Applies the commands the main thread posts
+// and keeps the shared ring (see RenderThread.js) topped up with rendered
+// audio to the depth the main thread asks for, sleeping on the ring's read
+// position while it is there.
+
+import { parentPort, workerData } from 'worker_threads';
+import { WasmAudioEngine } from './WasmAudioEngine.js';
+import {
+    FORWARDED_METHODS,
+    RING_WRITE,
+    RING_READ,
+    RING_STOP,
+    RING_DEPTH,
+    RING_DATA_OFFSET
+} from './RenderThread.js';
+
+const { sab, capacity, numberOfChannels, sampleRate } = workerData;
+const header = new Int32Array(sab, 0, 4);
+const time = new BigInt64Array(sab, 16, 1);
+const ring = new Float32Array(sab, RING_DATA_OFFSET, capacity);
+
+// Frames rendered per WASM call: a few quanta, small enough that commands are
+// picked up promptly while the ring is being filled.
+const CHUNK_FRAMES = 128 * 4;
+
+const engine = new WasmAudioEngine(numberOfChannels, CHUNK_FRAMES, sampleRate, true);
+engine.reserveRenderBuffer(CHUNK_FRAMES);
+
+// Main-thread node id -> graph handle
+const nodes = new Map();
+
+function applyCommand(method, args) {
+    if (method === 'createNode') {
+        const [nodeId, type] = args;
+        nodes.set(nodeId, engine.createNode(type));
+        return;
+    }
+
+    const nodeArgs = FORWARDED_METHODS[method];
+    if (!nodeArgs) return;
+    const nodeId = args[0];
+    for (const i of nodeArgs) {
+        if (args[i] !== undefined) args[i] = nodes.get(args[i]) ?? 0;
+    }
+    engine[method](...args);
+
+    // The main thread never names these nodes again
+    if (method === 'releaseNode' || method === 'destroyNode') {
+        nodes.delete(nodeId);
+    }
+}
+
+// Graph handles -> main-thread node ids, for results that name nodes
+function mainThreadIds(items) {
+    const nodeIds = new Map([...nodes].map(([nodeId, handle]) => [handle, nodeId]));
+    for (const item of items) {
+        if (item.id > 0) item.id = nodeIds.get(item.id) ?? 0;
+    }
+}
+
+// Queries from WorkerRenderEngine._request
+const REQUESTS = {
+    takeRenderStats: () => engine.takeRenderStats(),
+    getGraphProfile: () => {
+        const profile = engine.getGraphProfile();
+        if (profile) mainThreadIds(profile.nodes);
+        return profile;
+    },
+    takeTrace: () => {
+        const trace = engine.takeTrace();
+        if (trace) mainThreadIds(trace.events);
+        return trace;
+    },
+    mappedNodeIds: () => [...nodes.keys()]
+};
+
+// Render into the ring until it holds the requested depth. Returns false if
+// it already does.
+function fill() {
+    const write = Atomics.load(header, RING_WRITE);
+    const read = Atomics.load(header, RING_READ);
+    const missing = Atomics.load(header, RING_DEPTH) - ((write - read + capacity) % capacity);
+    const frames = Math.min(CHUNK_FRAMES, Math.floor(missing / numberOfChannels));
+    if (frames <= 0) return false;
+
+    const bytes = engine.renderBlockBytes(frames);
+    const samples = new Float32Array(bytes.buffer, bytes.byteOffset, frames * numberOfChannels);
+    const first = Math.min(samples.length, capacity - write);
+    ring.set(samples.subarray(0, first), write);
+    if (samples.length > first) {
+        ring.set(samples.subarray(first), 0);
+    }
+
+    Atomics.store(time, 0, BigInt(Math.round(engine.getCurrentTime() * sampleRate)));
+    Atomics.store(header, RING_WRITE, (write + samples.length) % capacity);
+    return true;
+}
+
+const yieldToMessages = () => new Promise(resolve => setImmediate(resolve));
+
+async function renderLoop() {
+    let primed = false;
+    while (!Atomics.load(header, RING_STOP)) {
+        if (fill()) {
+            // Let queued commands in between chunks
+            await yieldToMessages();
+            continue;
+        }
+        if (!primed) {
+            primed = true;
+            parentPort.postMessage('primed');
+        }
+        // At depth: sleep until the consumer takes some (or the depth grows).
+        // The timeout keeps commands flowing while playback is suspended.
+        const read = Atomics.load(header, RING_READ);
+        await Atomics.waitAsync(header, RING_READ, read, 20).value;
+    }
+    engine.destroy();
+}
+
+parentPort.on('message', message => {
+    if (message.commands) {
+        for (const [method, args] of message.commands) {
+            // One bad edit shouldn't take the render thread (and the audio)
+            // down with it; the caller has already moved on.
+            try {
+                applyCommand(method, args);
+            } catch (error) {
+                console.error(`[RenderWorker] ${method} failed:`, error);
+            }
+        }
+    }
+    if (message.request) {
+        parentPort.postMessage({ reply: message.id, value: REQUESTS[message.request]?.() ?? null });
+    }
+    if (message.start) {
+        renderLoop();
+    }
+});
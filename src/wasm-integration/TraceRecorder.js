@@ -0,0 +1,109 @@
+// Chrome Trace Event export for contexts created with { trace: true }
+//
+// Collects the events the graph records natively (see WasmAudioEngine.takeTrace)
+// plus counters sampled in JS, and builds the JSON object format that Perfetto
+// (ui.perfetto.dev) and chrome://tracing open directly:
+//
+//   fs.writeFileSync('render.json', JSON.stringify(ctx.getTrace()));
+//
+// Every node's process call is a slice nested in its render quantum, start/
+// stop and param changes are instant events, and heap size and output queue
+// depth are counters.
+
+const PID = 1;
+const RENDER_TID = 1; // where the graph renders (main thread or render worker)
+const OUTPUT_TID = 2; // the SDL feeder
+
+// Native events kept between drains: well above what one drain interval
+// records, so only huge offline renders can run out.
+export const TRACE_CAPACITY = 1 << 20;
+
+export class TraceRecorder {
+    constructor() {
+        this._events = [];
+        this._dropped = 0;
+    }
+
+    // Append what WasmAudioEngine.takeTrace returned
+    add(trace) {
+        if (!trace) return;
+        this._dropped += trace.dropped;
+
+        for (const event of trace.events) {
+            const ts = event.ts * 1000; // trace timestamps are microseconds
+            switch (event.phase) {
+                case 'node':
+                    this._events.push({
+                        name: event.type,
+                        cat: 'node',
+                        ph: 'X',
+                        ts,
+                        dur: event.dur * 1000,
+                        pid: PID,
+                        tid: RENDER_TID,
+                        args: { node: event.id, time: event.when, audible: event.value !== 0 }
+                    });
+                    break;
+                case 'quantum':
+                    this._events.push({
+                        name: 'quantum',
+                        cat: 'graph',
+                        ph: 'X',
+                        ts,
+                        dur: event.dur * 1000,
+                        pid: PID,
+                        tid: RENDER_TID,
+                        args: { time: event.when, frames: event.value }
+                    });
+                    break;
+                case 'start':
+                case 'stop':
+                    this._events.push({
+                        name: `${event.phase} ${event.type}`,
+                        cat: 'schedule',
+                        ph: 'i',
+                        s: 't',
+                        ts,
+                        pid: PID,
+                        tid: RENDER_TID,
+                        args: { node: event.id, when: event.when }
+                    });
+                    break;
+                case 'param':
+                    this._events.push({
+                        name: `${event.type}.${event.param}`,
+                        cat: 'param',
+                        ph: 'i',
+                        s: 't',
+                        ts,
+                        pid: PID,
+                        tid: RENDER_TID,
+                        args: { node: event.id, value: event.value, when: event.when }
+                    });
+                    break;
+                case 'heap':
+                    this.counter('heap', { bytes: event.value }, event.ts, RENDER_TID);
+                    break;
+            }
+        }
+    }
+
+    // Sample a counter (`values` maps series name to number) at `ts`, in
+    // milliseconds since the epoch
+    counter(name, values, ts = performance.timeOrigin + performance.now(), tid = OUTPUT_TID) {
+        this._events.push({ name, ph: 'C', ts: ts * 1000, pid: PID, tid, args: values });
+    }
+
+    toJSON() {
+        const metadata = [
+            { name: 'process_name', ph: 'M', pid: PID, args: { name: 'webaudio-node' } },
+            { name: 'thread_name', ph: 'M', pid: PID, tid: RENDER_TID, args: { name: 'render' } },
+            { name: 'thread_name', ph: 'M', pid: PID, tid: OUTPUT_TID, args: { name: 'output' } }
+        ];
+        return {
+            traceEvents: metadata.concat(this._events),
+            displayTimeUnit: 'ms',
+            otherData: { droppedEvents: this._dropped }
+        };
+    }
+}
@@ -2,6 +2,10 @@
 // Real-time audio playback using WASM AudioGraph
 
 import { WasmAudioEngine } from './WasmAudioEngine.js';
+import { WorkerRenderEngine } from './RenderThread.js';
+import { LatencyController } from './LatencyController.js';
+import { AudioRenderCapacity } from './AudioRenderCapacity.js';
+import { TraceRecorder, TRACE_CAPACITY } from './TraceRecorder.js';
 import { AudioDestinationNode } from '../javascript/nodes/AudioDestinationNode.js';
 import { GainNode } from '../javascript/nodes/GainNode.js';
 import { OscillatorNode } from '../javascript/nodes/OscillatorNode.js';
@@ -55,14 +59,48 @@ export class WasmAudioContext {
         this._channels = options.numberOfChannels || 2;
         this._bufferSize = options.bufferSize || 128; // Web Audio quantum size
 
-        // Create WASM audio engine (WASM is preloaded, so this is synchronous)
-        this._engine = new WasmAudioEngine(
-            this._channels,
-            this._bufferSize * 1000, // length doesn't matter for real-time
+        // How deep the SDL queue is kept; adapts to underruns while running.
+        // With renderThread: 'worker' this thread still feeds SDL, so the
+        // queue is kept stallTolerance seconds (default 0.1) deeper to ride
+        // out main-thread stalls that long, at the cost of as much latency.
+        const worker = options.renderThread === 'worker';
+        this._latency = new LatencyController(
+            options.latencyHint ?? 'interactive',
             this.sampleRate,
-            true // isRealtime - time managed by JavaScript
+            worker ? (options.stallTolerance ?? 0.1) : 0
         );
 
+        // Create WASM audio engine (WASM is preloaded, so this is synchronous).
+        // With renderThread: 'worker' the graph renders on a worker thread and
+        // this thread only moves rendered audio into SDL.
+        if (worker) {
+            // Audio in the ring is already rendered, so graph edits wait
+            // behind it: the worker only renders the latency target ahead,
+            // in a ring sized for the most the controller may ask for.
+            this._engine = new WorkerRenderEngine(
+                this._channels,
+                this.sampleRate,
+                this._latency.max,
+                this._latency.target
+            );
+        } else {
+            this._engine = new WasmAudioEngine(
+                this._channels,
+                this._bufferSize * 1000, // length doesn't matter for real-time
+                this.sampleRate,
+                true // isRealtime - time managed by JavaScript
+            );
+        }
+
+        // Non-standard: { profile: true } records per-node timing for
+        // getGraphProfile()
+        if (options.profile) this._engine.setProfiling(true);
+
+        // Non-standard: { trace: true } records a Chrome trace for getTrace()
+        this._trace = options.trace ? new TraceRecorder() : null;
+        this._traceTicks = 0;
+        if (this._trace) this._engine.setTracing(TRACE_CAPACITY);
+
         // Route AudioBuffer's lazy de-interleave (getChannelData) through the WASM
         // SIMD deinterleave instead of a JS per-sample loop.
         const wasmModule = this._engine.wasmModule;
@@ -76,12 +114,38 @@ export class WasmAudioContext {
         const destNodeId = this._engine.createNode('destination');
         this.destination = new AudioDestinationNode(this, destNodeId);
 
+        this.renderCapacity = new AudioRenderCapacity(this);
+
         this.state = 'suspended';
         this._audioDevice = null;
         this._startTime = null;
         this._sinkId = ''; // Empty string means default device (browser-compatible)
     }
 
+    // Seconds of audio queued between the graph and the device: the
+    // controller's current queue depth (including any stall tolerance), plus
+    // what the render worker has rendered ahead in its ring
+    get baseLatency() {
+        const ringFrames = this._engine.isWorker ? this._engine.bufferedFrames : 0;
+        return this._latency.queueTarget + ringFrames / this.sampleRate;
+    }
+
+    // Seconds the device itself buffers after the queue
+    get outputLatency() {
+        const frames = this._audioDevice?.buffered ?? this._latency.deviceFrames;
+        return frames / this.sampleRate;
+    }
+
+    _openDevice(device) {
+        return getSdl().audio.openDevice(device, {
+            type: 'playback',
+            frequency: this.sampleRate,
+            channels: this._channels,
+            format: 'f32',
+            buffered: this._latency.deviceFrames // Power of 2, in frames
+        });
+    }
+
     // Browser-compatible sinkId property
     get sinkId() {
         return this._sinkId;
@@ -149,14 +213,7 @@ export class WasmAudioContext {
             this._sinkId = sinkId;
 
             // Re-open with new device
-            const device = this._findDeviceBySinkId(sinkId);
-            this._audioDevice = getSdl().audio.openDevice(device, {
-                type: 'playback',
-                frequency: this.sampleRate,
-                channels: this._channels,
-                format: 'f32',
-                buffered: 65536 // Power of 2 buffer size (2^16 bytes)
-            });
+            this._audioDevice = this._openDevice(this._findDeviceBySinkId(sinkId));
 
             // Restore timing (approximate)
             this._startTime = Date.now() - savedTime * 1000;
@@ -165,7 +222,8 @@ export class WasmAudioContext {
             this._engine.setCurrentTime(savedTime);
 
             // Pre-render and start playback
-            this._renderAndEnqueueChunk(this.sampleRate * 2);
+            this._renderAndEnqueueChunk(this._latency.framesToQueue(0));
+            this._latency.reset();
             this._audioDevice.play();
         } else {
             // Just update the sink ID for next resume()
@@ -173,6 +231,25 @@ export class WasmAudioContext {
         }
     }
 
+    // Non-standard: per-node timing when created with { profile: true }.
+    // A promise in worker mode, where the graph lives.
+    getGraphProfile() {
+        return this._engine.getGraphProfile();
+    }
+
+    // Non-standard: everything traced so far as a Chrome Trace Event JSON
+    // object (open it in Perfetto or chrome://tracing), or null without
+    // { trace: true }
+    async getTrace() {
+        if (!this._trace) return null;
+        await this._drainTrace();
+        return this._trace.toJSON();
+    }
+
+    async _drainTrace() {
+        this._trace.add(await this._engine.takeTrace());
+    }
+
     get currentTime() {
         // Get precise sample-based time from WASM
         return this._engine.getCurrentTime();
@@ -250,6 +327,9 @@ export class WasmAudioContext {
     }
 
     createMediaStreamSource(options) {
+        if (this._engine.isWorker) {
+            throw new Error("createMediaStreamSource is not supported with renderThread: 'worker'");
+        }
         return new MediaStreamSourceNode(this, options);
     }
 
@@ -261,25 +341,27 @@ export class WasmAudioContext {
             const device = this._findDeviceBySinkId(this._sinkId);
 
             // Open SDL audio device (queue-based, not callback-based)
-            // Note: buffered must be a power of 2
-            this._audioDevice = getSdl().audio.openDevice(device, {
-                type: 'playback',
-                frequency: this.sampleRate,
-                channels: this._channels,
-                format: 'f32',
-                buffered: 65536 // Power of 2 buffer size (2^16 bytes)
-            });
+            this._audioDevice = this._openDevice(device);
+
+            // The worker renders ahead on its own; wait for its ring to fill
+            if (this._engine.isWorker) {
+                await this._engine.start();
+            }
 
             this._startTime = Date.now();
             this.state = 'running';
 
-            // Pre-allocate reusable buffer for rendering (avoid allocations in hot path)
-            const maxChunkFrames = Math.ceil(this.sampleRate * 0.2); // 200ms max chunks
-            this._renderBuffer = new Float32Array(maxChunkFrames * this._channels);
-            this._renderBufferAsBuffer = Buffer.from(this._renderBuffer.buffer);
+            // Reserve the engine's render region for the largest chunk up front
+            // (avoid allocations in hot path): a refill never exceeds the
+            // deepest queue the latency controller may ask for.
+            if (!this._engine.isWorker) {
+                const maxFrames = Math.ceil(this.sampleRate * this._latency.max);
+                this._engine.reserveRenderBuffer(maxFrames + 128);
+            }
 
-            // Pre-render initial chunk (200ms) before starting playback
-            this._renderAndEnqueueChunk(Math.ceil(this.sampleRate * 0.2));
+            // Pre-render up to the target queue depth before starting playback
+            this._renderAndEnqueueChunk(this._latency.framesToQueue(0));
+            this._latency.reset();
 
             // Start playback
             this._audioDevice.play();
@@ -293,15 +375,16 @@ export class WasmAudioContext {
     }
 
     _renderAndEnqueueChunk(numFrames) {
-        // Reuse pre-allocated buffer (no allocation in hot path!)
-        const totalSamples = numFrames * this._channels;
-        const floatBuffer = this._renderBuffer.subarray(0, totalSamples);
-
-        // Render audio using WASM engine (time managed entirely in WASM)
-        this._engine.renderBlock(floatBuffer, numFrames);
+        // Worker mode: hand over what the worker has already rendered
+        if (this._engine.isWorker) {
+            this._engine.enqueueRendered(this._audioDevice, numFrames);
+            return;
+        }
 
-        // Use pre-allocated Buffer view (no copy!)
-        const buffer = this._renderBufferAsBuffer.subarray(0, totalSamples * 4);
+        // Render audio using WASM engine (time managed entirely in WASM) into
+        // its persistent render region, and enqueue a Buffer view over that
+        // region: no allocation and no copy before SDL's own.
+        const buffer = this._engine.renderBlockBytes(numFrames);
 
         // Enqueue audio data to SDL
         this._audioDevice.enqueue(buffer);
@@ -314,15 +397,27 @@ export class WasmAudioContext {
         const queuedBytes = this._audioDevice.queued;
         const queuedSeconds = queuedBytes / (this.sampleRate * this._channels * 4);
 
-        // Keep buffer at 150-250ms for stability without too much latency
-        if (queuedSeconds < 0.2) {
-            // Render 32ms chunks (slightly larger than browser quantum size)
-            const framesToRender = Math.ceil(this.sampleRate * 0.032);
+        // Let the controller see underruns (and quiet stretches), then top
+        // the queue back up to its target depth
+        this._latency.update(queuedSeconds);
+        if (this._engine.isWorker) this._engine.setRingDepth(this._latency.target);
+        if (this._trace) {
+            this._trace.counter('queue', {
+                seconds: queuedSeconds,
+                target: this._latency.queueTarget
+            });
+            // Move native events over about once a second
+            if (++this._traceTicks % Math.ceil(1000 / this._latency.tickMs) === 0) {
+                this._drainTrace();
+            }
+        }
+        const framesToRender = this._latency.framesToQueue(queuedSeconds);
+        if (framesToRender > 0) {
             this._renderAndEnqueueChunk(framesToRender);
         }
 
-        // Check every 10ms - good balance
-        setTimeout(() => this._monitorLoop(), 10);
+        // Tick several times per target period (at most every 10ms)
+        setTimeout(() => this._monitorLoop(), this._latency.tickMs);
     }
 
     async suspend() {
@@ -336,6 +431,8 @@ export class WasmAudioContext {
 
     async close() {
         this.state = 'closed';
+        this.renderCapacity.stop();
+        if (this._trace) await this._drainTrace();
 
         if (this._audioDevice) {
             this._audioDevice.close();
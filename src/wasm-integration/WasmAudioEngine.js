@@ -3,6 +3,7 @@
 
 import { wasmModule as defaultWasmModule } from './WasmModule.js';
 import { WasmAudioDecoders } from './WasmAudioDecoders.js';
+import { CommandBuffer } from './CommandBuffer.js';
 
 // Parameter name to ID mapping - matches C++ ParamID enum
 // Eliminates malloc/copy/free overhead on every parameter change
@@ -36,7 +37,8 @@ const PARAM_ID_MAP = {
     positionZ: 26,
     orientationX: 27,
     orientationY: 28,
-    orientationZ: 29
+    orientationZ: 29,
+    playbackRate: 30
 };
 
 // Helper to safely copy data to WASM heap, handling potential memory growth
@@ -67,6 +69,68 @@ function copyToWasmHeap(wasmModule, data, ptr) {
     heapView.set(floatArray);
 }
 
+// Node type names in C++ NodeKind order: createNode passes the index, and
+// getGraphProfile rows are read back through it
+const NODE_KIND_NAMES = [
+    'destination',
+    'oscillator',
+    'gain',
+    'bufferSource',
+    'biquadFilter',
+    'delay',
+    'waveShaper',
+    'stereoPanner',
+    'constantSource',
+    'convolver',
+    'dynamicsCompressor',
+    'analyser',
+    'panner',
+    'IIRFilter',
+    'channelSplitter',
+    'channelMerger',
+    'mediaStreamSource'
+];
+
+// createNode type name to C++ NodeKind, including the spellings nodes use
+const NODE_KIND_IDS = Object.fromEntries(NODE_KIND_NAMES.map((name, kind) => [name, kind]));
+NODE_KIND_IDS['media-stream-source'] = NODE_KIND_IDS.mediaStreamSource;
+
+// Node property name to ID - matches C++ NodeProperty enum
+const PROPERTY_ID_MAP = {
+    type: 0,
+    oversample: 1,
+    normalize: 2,
+    fftSize: 3,
+    minDecibels: 4,
+    maxDecibels: 5,
+    smoothingTimeConstant: 6,
+    panningModel: 7,
+    distanceModel: 8,
+    interpolation: 9
+};
+
+// Enumerated property values; the engine sends their index
+const PROPERTY_VALUES = {
+    oversample: ['none', '2x', '4x'],
+    panningModel: ['equalpower', 'HRTF'],
+    distanceModel: ['linear', 'inverse', 'exponential'],
+    interpolation: ['linear', 'cubic', 'sinc']
+};
+
+// Doubles per getGraphProfile row: handle, kind, calls, total ms, max ms, bytes
+const PROFILE_FIELDS = 6;
+
+// C++ TracePhase values by index, and the doubles per takeGraphTrace row:
+// phase, handle, kind, param, ts, dur, when, value
+const TRACE_PHASES = ['node', 'quantum', 'start', 'stop', 'param', 'heap'];
+const TRACE_FIELDS = 8;
+
+// Param names by C++ ParamID, for trace events
+const PARAM_NAMES = [];
+for (const [name, id] of Object.entries(PARAM_ID_MAP)) {
+    PARAM_NAMES[id] ??= name;
+}
+
 export class WasmAudioEngine {
     constructor(numberOfChannels, length, sampleRate, isRealtime = false, wasmModule = null) {
         this.numberOfChannels = numberOfChannels;
@@ -84,31 +148,85 @@ export class WasmAudioEngine {
             isRealtime ? 1 : 0 // Convert boolean to integer for C++
         );
         this.initialized = true;
+
+        // Persistent render region in WASM memory for the real-time path
+        // (renderBlock / renderBlockBytes): allocated once, grown only if a
+        // larger block is asked for, freed in destroy().
+        this._renderPtr = 0;
+        this._renderFrames = 0;
+
+        // Where takeRenderStats reads the native render timing (4 doubles)
+        this._statsPtr = 0;
+
+        // Param changes, scheduling, connections and releases are queued here
+        // and applied in one WASM call (flushCommands) before the next render,
+        // or before any call that must see them.
+        this._commands = new CommandBuffer(this.wasmModule, () => this.flushCommands());
+
+        // Tell the graph when a node wrapper is garbage collected, so finished
+        // one-shot sources (and whatever they alone fed) get freed natively
+        // instead of staying in the graph for the life of the context.
+        this._nodeRegistry =
+            typeof FinalizationRegistry === 'function'
+                ? new FinalizationRegistry(nodeId => this.releaseNode(nodeId))
+                : null;
+        // Likewise for AudioBuffers registered with the graph's sample store,
+        // by AudioBuffer id with the version of the samples registered (see
+        // AudioBuffer._registerWith)
+        this._registeredBuffers = new Map();
+        this._bufferRegistry =
+            typeof FinalizationRegistry === 'function'
+                ? new FinalizationRegistry(bufferId => this.releaseBuffer(bufferId))
+                : null;
+    }
+
+    // Apply the queued commands now
+    flushCommands() {
+        const commands = this._commands;
+        if (commands.length === 0) return;
+        if (this.graphId !== null) {
+            this.wasmModule._applyCommands(this.graphId, commands.ptr, commands.length);
+        }
+        commands.length = 0;
     }
 
     createNode(type, _options = {}) {
         // Just forward to WASM - no JavaScript graph management!
-        // Allocate string in WASM memory
-        const lengthBytes = this.wasmModule.lengthBytesUTF8(type) + 1;
-        const typePtr = this.wasmModule._malloc(lengthBytes);
-        this.wasmModule.stringToUTF8(type, typePtr, lengthBytes);
+        const kind = NODE_KIND_IDS[type];
+        if (kind === undefined) return 0; // not a native node type
+        return this.wasmModule._createNode(this.graphId, kind);
+    }
+
+    /**
+     * Register a JS node wrapper; once it is collected the graph may reclaim
+     * the native node as soon as it can no longer be heard.
+     */
+    trackNode(node, nodeId) {
+        if (this._nodeRegistry && nodeId) this._nodeRegistry.register(node, nodeId);
+    }
+
+    /** The JS side holds no more references to this node. */
+    releaseNode(nodeId) {
+        if (this.graphId === null) return;
+        this._commands.release(nodeId);
+    }
 
-        const nodeId = this.wasmModule._createNode(this.graphId, typePtr);
-        this.wasmModule._free(typePtr);
-        return nodeId;
+    /** Remove a node immediately, wherever it is connected. */
+    destroyNode(nodeId) {
+        if (this.graphId === null) return;
+        this._commands.destroy(nodeId);
     }
 
     connectNodes(sourceId, destId, sourceOutput = 0, destInput = 0) {
-        this.wasmModule._connectNodes(this.graphId, sourceId, destId, sourceOutput, destInput);
+        this._commands.connect(sourceId, destId, sourceOutput, destInput);
     }
 
+    // Audio-rate param input: the source's output is added to the param's
+    // value frame by frame (LFOs, FM, sidechain gain)
     connectToParam(sourceId, destId, paramName, sourceOutput = 0) {
-        const lengthBytes = this.wasmModule.lengthBytesUTF8(paramName) + 1;
-        const paramNamePtr = this.wasmModule._malloc(lengthBytes);
-        this.wasmModule.stringToUTF8(paramName, paramNamePtr, lengthBytes);
-
-        this.wasmModule._connectToParam(this.graphId, sourceId, destId, paramNamePtr, sourceOutput);
-        this.wasmModule._free(paramNamePtr);
+        const paramId = PARAM_ID_MAP[paramName];
+        if (paramId === undefined) return;
+        this._commands.connectParam(sourceId, destId, paramId, sourceOutput);
     }
 
     /**
@@ -119,7 +237,7 @@ export class WasmAudioEngine {
      *                          the source from everything it feeds
      */
     disconnectNodes(nodeId, destId) {
-        this.wasmModule._disconnectNodes(this.graphId, nodeId, destId === undefined ? -1 : destId);
+        this._commands.disconnect(nodeId, destId === undefined ? -1 : destId);
     }
 
     /** Back-compat alias: disconnect this node from every destination. */
@@ -140,12 +258,11 @@ export class WasmAudioEngine {
         if (outputIndex === 0) this.disconnectNodes(nodeId, undefined);
     }
 
-    /**
-     * disconnect(audioParam) — param connections are not modelled yet
-     * (connectToParam is itself still a stub), so there is nothing to undo.
-     */
-    disconnectFromParam(_nodeId, _destId, _paramName) {
-        // no-op until connectToParam is implemented
+    /** disconnect(audioParam) — undo one connectToParam. */
+    disconnectFromParam(nodeId, destId, paramName) {
+        const paramId = PARAM_ID_MAP[paramName];
+        if (paramId === undefined) return;
+        this._commands.disconnectParam(nodeId, destId, paramId);
     }
 
     setNodeParameter(nodeId, paramName, value) {
@@ -156,10 +273,12 @@ export class WasmAudioEngine {
             return;
         }
 
-        this.wasmModule._setNodeParameter(this.graphId, nodeId, paramId, value);
+        this._commands.setParam(nodeId, paramId, value);
     }
 
     setNodeBuffer(nodeId, bufferData, length, channels) {
+        this.flushCommands();
+
         // Allocate WASM memory for buffer data
         const totalSamples = length * channels;
         const bufferPtr = this.wasmModule._malloc(totalSamples * 4); // 4 bytes per float
@@ -169,11 +288,13 @@ export class WasmAudioEngine {
 
         this.wasmModule._setNodeBuffer(this.graphId, nodeId, bufferPtr, length, channels);
 
-        // Free the temporary buffer - WASM copies the data internally
-        this.wasmModule._free(bufferPtr);
+        // Don't free - the graph owns the block now (a buffer source plays it
+        // in place)
     }
 
     setIIRFilterCoefficients(nodeId, feedforward, feedback) {
+        this.flushCommands();
+
         // Allocate WASM memory for feedforward coefficients
         const ffPtr = this.wasmModule._malloc(feedforward.length * 4);
         copyToWasmHeap(this.wasmModule, feedforward, ffPtr);
@@ -209,99 +330,67 @@ export class WasmAudioEngine {
         if (paramId === undefined) return;
         // kind int for wasm: 0 setValue, 1 linearRamp, 2 expoRamp, 3 setTarget,
         // 4 cancelScheduledValues/cancelAndHoldAtTime.
+        const commands = this._commands;
         switch (kind) {
             case 'setValueAtTime':
-                this.wasmModule._scheduleParamEvent(
-                    this.graphId,
-                    nodeId,
-                    paramId,
-                    0,
-                    value,
-                    time,
-                    0
-                );
+                commands.scheduleParam(nodeId, paramId, 0, value, time, 0);
                 return;
             case 'linearRampToValueAtTime':
-                this.wasmModule._scheduleParamEvent(
-                    this.graphId,
-                    nodeId,
-                    paramId,
-                    1,
-                    value,
-                    time,
-                    0
-                );
+                commands.scheduleParam(nodeId, paramId, 1, value, time, 0);
                 return;
             case 'exponentialRampToValueAtTime':
-                this.wasmModule._scheduleParamEvent(
-                    this.graphId,
-                    nodeId,
-                    paramId,
-                    2,
-                    value,
-                    time,
-                    0
-                );
+                commands.scheduleParam(nodeId, paramId, 2, value, time, 0);
                 return;
             case 'setTargetAtTime':
-                this.wasmModule._scheduleParamEvent(
-                    this.graphId,
-                    nodeId,
-                    paramId,
-                    3,
-                    value,
-                    time,
-                    extra || 0
-                );
+                commands.scheduleParam(nodeId, paramId, 3, value, time, extra || 0);
                 return;
             case 'cancelScheduledValues':
             case 'cancelAndHoldAtTime':
                 // value carries the cancel TIME for these.
-                this.wasmModule._scheduleParamEvent(this.graphId, nodeId, paramId, 4, 0, value, 0);
+                commands.scheduleParam(nodeId, paramId, 4, 0, value, 0);
                 return;
             case 'setValueCurveAtTime':
-                // Approximate a value curve as setValueAtTime points across
-                // [time, time+duration]. value=array, time=start, extra=duration.
-                if (Array.isArray(value) && value.length > 0 && extra > 0) {
-                    const n = value.length,
-                        dur = extra;
-                    for (let i = 0; i < n; i++) {
-                        const tt = time + (dur * i) / (n - 1 || 1);
-                        this.wasmModule._scheduleParamEvent(
-                            this.graphId,
-                            nodeId,
-                            paramId,
-                            0,
-                            value[i],
-                            tt,
-                            0
-                        );
-                    }
+                // One curve event, interpolated natively. value=points,
+                // time=start, extra=duration.
+                if (value.length > 0 && extra > 0) {
+                    this._scheduleParamCurve(nodeId, paramId, value, time, extra);
                 }
                 return;
             default:
-                this.wasmModule._scheduleParamEvent(
-                    this.graphId,
-                    nodeId,
-                    paramId,
-                    0,
-                    value,
-                    time,
-                    0
-                );
+                commands.scheduleParam(nodeId, paramId, 0, value, time, 0);
                 return;
         }
     }
 
+    // The points go straight to WASM, after the commands queued before them
+    _scheduleParamCurve(nodeId, paramId, values, time, duration) {
+        this.flushCommands();
+        const valuesPtr = this.wasmModule._malloc(values.length * 4);
+        copyToWasmHeap(this.wasmModule, values, valuesPtr);
+        this.wasmModule._scheduleParamCurve(
+            this.graphId,
+            nodeId,
+            paramId,
+            valuesPtr,
+            values.length,
+            time,
+            duration
+        );
+        // Free the temporary points - WASM copies them
+        this.wasmModule._free(valuesPtr);
+    }
+
     startNode(nodeId, when = 0) {
-        this.wasmModule._startNode(this.graphId, nodeId, when);
+        this._commands.start(nodeId, when);
     }
 
     stopNode(nodeId, when = 0) {
-        this.wasmModule._stopNode(this.graphId, nodeId, when);
+        this._commands.stop(nodeId, when);
     }
 
     registerBuffer(bufferId, bufferData, length, channels, sourceSampleRate = this.sampleRate) {
+        this.flushCommands();
+
         let registeredBuffer = {
             audioData: bufferData,
             length
@@ -331,14 +420,31 @@ export class WasmAudioEngine {
             registeredBuffer.length,
             channels
         );
-        // Don't free - WASM keeps a reference
+        // Don't free - the graph's sample store owns the block now
+    }
+
+    /**
+     * Drop the graph's copy of a registered buffer. Sources still playing it
+     * keep the PCM alive until they are done.
+     */
+    releaseBuffer(bufferId) {
+        this._registeredBuffers.delete(bufferId);
+        if (this.graphId === null) return;
+        this.flushCommands();
+        this.wasmModule._releaseBuffer(this.graphId, bufferId);
+    }
+
+    /** Release `bufferId` from the graph once `buffer` is garbage collected. */
+    trackBuffer(buffer, bufferId) {
+        if (this._bufferRegistry) this._bufferRegistry.register(buffer, bufferId);
     }
 
     setNodeBufferId(nodeId, bufferId) {
-        this.wasmModule._setNodeBufferId(this.graphId, nodeId, bufferId);
+        this._commands.setBufferId(nodeId, bufferId);
     }
 
     setWaveShaperCurve(nodeId, curve) {
+        this.flushCommands();
         const curvePtr = this.wasmModule._malloc(curve.length * 4);
 
         // Use HEAPF32.set() with subarray (avoids alignment issues and is fast)
@@ -350,52 +456,49 @@ export class WasmAudioEngine {
     }
 
     clearWaveShaperCurve(nodeId) {
+        this.flushCommands();
         // Set curve to null by passing 0 length
         this.wasmModule._setWaveShaperCurve(this.graphId, nodeId, 0, 0);
     }
 
-    setNodePeriodicWave(nodeId, wavetable) {
-        const wavetablePtr = this.wasmModule._malloc(wavetable.length * 4);
+    setNodePeriodicWave(nodeId, real, imag, disableNormalization) {
+        this.flushCommands();
+        const count = real.length;
+        const realPtr = this.wasmModule._malloc(count * 8);
+        const imagPtr = realPtr + count * 4;
+        copyToWasmHeap(this.wasmModule, real, realPtr);
+        copyToWasmHeap(this.wasmModule, imag, imagPtr);
 
-        // Use HEAPF32.set() with subarray (avoids alignment issues and is fast)
-        copyToWasmHeap(this.wasmModule, wavetable, wavetablePtr);
-
-        this.wasmModule._setNodePeriodicWave(this.graphId, nodeId, wavetablePtr, wavetable.length);
-        // Free the temporary wavetable - WASM copies the data internally
-        this.wasmModule._free(wavetablePtr);
+        // The graph builds the tables (or reuses a cached set); the coefficients
+        // are only read during the call
+        const normalize = disableNormalization ? 0 : 1;
+        this.wasmModule._setNodePeriodicWave(
+            this.graphId,
+            nodeId,
+            realPtr,
+            imagPtr,
+            count,
+            normalize
+        );
+        this.wasmModule._free(realPtr);
     }
 
     setWaveShaperOversample(nodeId, oversample) {
-        // Convert string oversample to C string
-        const valLengthBytes = this.wasmModule.lengthBytesUTF8(oversample) + 1;
-        const valPtr = this.wasmModule._malloc(valLengthBytes);
-        this.wasmModule.stringToUTF8(oversample, valPtr, valLengthBytes);
-
-        this.wasmModule._setWaveShaperOversample(this.graphId, nodeId, valPtr);
-        this.wasmModule._free(valPtr);
+        this.setNodeStringProperty(nodeId, 'oversample', oversample);
     }
 
+    // Numeric (or boolean) node property, e.g. the analyser's fftSize
     setNodeProperty(nodeId, property, value) {
-        const lengthBytes = this.wasmModule.lengthBytesUTF8(property) + 1;
-        const propertyPtr = this.wasmModule._malloc(lengthBytes);
-        this.wasmModule.stringToUTF8(property, propertyPtr, lengthBytes);
-
-        this.wasmModule._setNodeProperty(this.graphId, nodeId, propertyPtr, value);
-        this.wasmModule._free(propertyPtr);
+        const propertyId = PROPERTY_ID_MAP[property];
+        if (propertyId === undefined) return;
+        this._commands.setProperty(nodeId, propertyId, Number(value));
     }
 
+    // Enumerated node property, e.g. the panner's distanceModel
     setNodeStringProperty(nodeId, property, value) {
-        const propLengthBytes = this.wasmModule.lengthBytesUTF8(property) + 1;
-        const propPtr = this.wasmModule._malloc(propLengthBytes);
-        this.wasmModule.stringToUTF8(property, propPtr, propLengthBytes);
-
-        const valLengthBytes = this.wasmModule.lengthBytesUTF8(value) + 1;
-        const valPtr = this.wasmModule._malloc(valLengthBytes);
-        this.wasmModule.stringToUTF8(value, valPtr, valLengthBytes);
-
-        this.wasmModule._setNodeStringProperty(this.graphId, nodeId, propPtr, valPtr);
-        this.wasmModule._free(propPtr);
-        this.wasmModule._free(valPtr);
+        const index = PROPERTY_VALUES[property]?.indexOf(value) ?? -1;
+        if (index < 0) return;
+        this.setNodeProperty(nodeId, property, index);
     }
 
     // Analyser methods
@@ -442,74 +545,226 @@ export class WasmAudioEngine {
     // as WASM manages timing internally via sample counting
     setCurrentTime(time) {
         if (!this.initialized) return;
+        this.flushCommands(); // queued start/stop times are relative to the old clock
         this.wasmModule._setGraphCurrentTime(this.graphId, time);
     }
 
+    // Make sure the persistent render region holds frameCount frames. Call it
+    // with the largest block up front to keep allocation off the render path.
+    reserveRenderBuffer(frameCount) {
+        if (frameCount <= this._renderFrames) return;
+        if (this._renderPtr) this.wasmModule._free(this._renderPtr);
+        this._renderPtr = this.wasmModule._malloc(frameCount * this.numberOfChannels * 4);
+        this._renderFrames = frameCount;
+    }
+
     renderBlock(outputArray, frameCount) {
         if (!this.initialized) return;
 
         const totalSamples = frameCount * this.numberOfChannels;
-
-        // Allocate temp buffer in WASM
-        const outputPtr = this.wasmModule._malloc(totalSamples * 4);
+        this.reserveRenderBuffer(frameCount);
+        this.flushCommands();
 
         // Process graph in WASM
-        this.wasmModule._processGraph(this.graphId, outputPtr, frameCount);
+        this.wasmModule._processGraph(this.graphId, this._renderPtr, frameCount);
 
         // Copy result to output array using subarray (fast and avoids alignment issues)
-        const floatIndex = outputPtr >> 2;
+        const floatIndex = this._renderPtr >> 2;
         outputArray.set(this.wasmModule.HEAPF32.subarray(floatIndex, floatIndex + totalSamples));
-
-        // Free temp buffer
-        this.wasmModule._free(outputPtr);
     }
 
-    async render() {
-        // Allocate output buffer in WASM memory (interleaved)
-        const totalSamples = this.length * this.numberOfChannels;
-        const interleavedPtr = this.wasmModule._malloc(totalSamples * 4);
-
-        // Process in blocks (standard Web Audio quantum size)
-        const blockSize = 128;
-        const totalBlocks = Math.ceil(this.length / blockSize);
-
-        for (let block = 0; block < totalBlocks; block++) {
-            const startFrame = block * blockSize;
-            const framesToProcess = Math.min(blockSize, this.length - startFrame);
+    // Render frameCount frames and return them as a Buffer over the render
+    // region itself (interleaved float32, no copy). The view is only good until
+    // the next render, and until the heap grows: hand it straight to a consumer
+    // that copies it, such as SDL's enqueue.
+    renderBlockBytes(frameCount) {
+        if (!this.initialized) return null;
+
+        this.reserveRenderBuffer(frameCount);
+        this.flushCommands();
+        this.wasmModule._processGraph(this.graphId, this._renderPtr, frameCount);
+        return Buffer.from(
+            this.wasmModule.HEAPU8.buffer,
+            this._renderPtr,
+            frameCount * this.numberOfChannels * 4
+        );
+    }
 
-            // Call WASM processGraph - ALL graph traversal and processing happens in WASM!
-            this.wasmModule._processGraph(
+    // Render timing of the real-time path (processGraph) since the last call:
+    // { renderMs, audioMs, peakLoad, calls }. Each call starts a new period.
+    takeRenderStats() {
+        if (this.graphId === null) return null;
+        if (!this._statsPtr) this._statsPtr = this.wasmModule._malloc(4 * 8);
+
+        this.wasmModule._takeRenderStats(this.graphId, this._statsPtr);
+        const heap = this.wasmModule.HEAPF64;
+        const index = this._statsPtr >> 3;
+        const [renderMs, audioMs, peakLoad, calls] = heap.subarray(index, index + 4);
+        return { renderMs, audioMs, peakLoad, calls };
+    }
+
+    // Per-node profiling: time and calls of every node's process call, and
+    // bytes it allocated. Turning it on starts a new profile.
+    setProfiling(enabled) {
+        if (this.graphId === null) return;
+        this.wasmModule._setGraphProfiling(this.graphId, enabled ? 1 : 0);
+    }
+
+    // The profile so far: { nodes: [{ id, type, calls, totalMs, maxMs, bytes }]
+    // (slowest first), types: { [type]: totals }, overhead: graph time outside
+    // the nodes }
+    getGraphProfile() {
+        if (this.graphId === null) return null;
+        const ptr = this.wasmModule._getGraphProfile(this.graphId);
+        if (!ptr) return null;
+
+        const heap = this.wasmModule.HEAPF64;
+        const base = ptr >> 3;
+        const profile = { nodes: [], types: {}, overhead: null };
+        for (let row = 0; row < heap[base]; row++) {
+            const i = base + 1 + row * PROFILE_FIELDS;
+            const id = heap[i];
+            const type = NODE_KIND_NAMES[heap[i + 1]];
+            const totals = {
+                calls: heap[i + 2],
+                totalMs: heap[i + 3],
+                maxMs: heap[i + 4],
+                bytes: heap[i + 5]
+            };
+            if (id > 0) profile.nodes.push({ id, type, ...totals });
+            else if (id === 0) profile.types[type] = totals;
+            else profile.overhead = totals;
+        }
+        profile.nodes.sort((a, b) => b.totalMs - a.totalMs);
+        return profile;
+    }
+
+    // Record trace events (node and quantum timing, heap size, start/stop and
+    // param changes), keeping up to `capacity` between takeTrace calls.
+    // 0 stops recording.
+    setTracing(capacity) {
+        if (this.graphId === null) return;
+        this.wasmModule._setGraphTracing(this.graphId, capacity);
+    }
+
+    // The events recorded since the last call, oldest first:
+    // { events: [{ phase, id, type, param, ts, dur, when, value }], dropped }.
+    // ts and dur are milliseconds, ts since the epoch (so traces from
+    // different threads line up); `when` is graph time in seconds.
+    takeTrace() {
+        if (this.graphId === null) return null;
+        const ptr = this.wasmModule._takeGraphTrace(this.graphId);
+        if (!ptr) return null;
+
+        const heap = this.wasmModule.HEAPF64;
+        const base = ptr >> 3;
+        const origin = performance.timeOrigin;
+        const events = new Array(heap[base]);
+        for (let e = 0; e < events.length; e++) {
+            const i = base + 2 + e * TRACE_FIELDS;
+            events[e] = {
+                phase: TRACE_PHASES[heap[i]],
+                id: heap[i + 1],
+                type: NODE_KIND_NAMES[heap[i + 2]],
+                param: PARAM_NAMES[heap[i + 3]],
+                ts: origin + heap[i + 4],
+                dur: heap[i + 5],
+                when: heap[i + 6],
+                value: heap[i + 7]
+            };
+        }
+        return { events, dropped: heap[base + 1] };
+    }
+
+    // onProgress(framesRendered, totalFrames), if given, is called every
+    // progressQuanta render quanta while WASM renders. It runs synchronously
+    // inside the render, so it can report but must not change the graph.
+    async render(onProgress = null, progressQuanta = 1024) {
+        // One planar buffer in WASM memory: the destination writes each quantum
+        // straight into its per-channel region, so there is no interleaved copy
+        // and no de-interleave pass over the result.
+        const length = this.length;
+        const planarPtr = this.wasmModule._malloc(length * this.numberOfChannels * 4);
+        this.flushCommands();
+
+        // The whole quantum loop runs in WASM: one call instead of one per
+        // 128 frames.
+        const progressPtr = onProgress
+            ? this.wasmModule.addFunction(
+                  (graphId, framesRendered, totalFrames) =>
+                      onProgress(framesRendered, totalFrames),
+                  'viii'
+              )
+            : 0;
+        try {
+            this.wasmModule._renderGraphRangePlanar(
                 this.graphId,
-                interleavedPtr + startFrame * this.numberOfChannels * 4,
-                framesToProcess
+                planarPtr,
+                length,
+                progressPtr,
+                progressQuanta
             );
-        }
-
-        // Allocate buffer for de-interleaved output (planar format)
-        const planarPtr = this.wasmModule._malloc(totalSamples * 4);
-
-        // De-interleave in WASM (SIMD-optimized!) instead of JavaScript
-        this.wasmModule._deinterleaveAudio(
-            interleavedPtr,
-            planarPtr,
-            this.length,
-            this.numberOfChannels
-        );
 
-        // Copy planar result to JavaScript array
-        const floatIndex = planarPtr >> 2;
-        const result = new Float32Array(
-            this.wasmModule.HEAPF32.subarray(floatIndex, floatIndex + totalSamples)
-        );
-
-        // Free WASM memory
-        this.wasmModule._free(interleavedPtr);
-        this.wasmModule._free(planarPtr);
+            // Copy each channel out of the heap once. Views would be cheaper
+            // but are detached as soon as the heap grows, and the heap is
+            // shared with every other context.
+            const base = planarPtr >> 2;
+            const channels = [];
+            for (let ch = 0; ch < this.numberOfChannels; ch++) {
+                channels.push(
+                    this.wasmModule.HEAPF32.slice(base + ch * length, base + (ch + 1) * length)
+                );
+            }
+            return channels;
+        } finally {
+            if (progressPtr) this.wasmModule.removeFunction(progressPtr);
+            this.wasmModule._free(planarPtr);
+        }
+    }
 
-        return result;
+    // Render in chunks of chunkFrames, handing each to write(chunk, framesRendered)
+    // as interleaved float32 as soon as it is produced. The chunk buffer is
+    // allocated once (in WASM memory and in JS) and reused, so memory use does
+    // not grow with the length of the render. `chunk` is overwritten by the next
+    // chunk; write may return a promise to hold rendering back until it is done
+    // with it.
+    async renderStream(write, chunkFrames) {
+        const channels = this.numberOfChannels;
+        const chunkPtr = this.wasmModule._malloc(chunkFrames * channels * 4);
+        const chunk = new Float32Array(chunkFrames * channels);
+
+        try {
+            for (let framesRendered = 0; framesRendered < this.length; ) {
+                const frames = Math.min(chunkFrames, this.length - framesRendered);
+                const samples = frames * channels;
+                this.flushCommands(); // write() may have changed the graph
+                this.wasmModule._renderGraphRange(this.graphId, chunkPtr, frames, 0, 0);
+
+                const floatIndex = chunkPtr >> 2;
+                chunk.set(this.wasmModule.HEAPF32.subarray(floatIndex, floatIndex + samples));
+                framesRendered += frames;
+                await write(
+                    samples === chunk.length ? chunk : chunk.subarray(0, samples),
+                    framesRendered
+                );
+            }
+        } finally {
+            this.wasmModule._free(chunkPtr);
+        }
     }
 
     destroy() {
+        // Pending commands die with the graph
+        this._commands.free();
+        if (this._statsPtr) {
+            this.wasmModule._free(this._statsPtr);
+            this._statsPtr = 0;
+        }
+        if (this._renderPtr) {
+            this.wasmModule._free(this._renderPtr);
+            this._renderPtr = 0;
+            this._renderFrames = 0;
+        }
         if (this.graphId !== null) {
             this.wasmModule._destroyAudioGraph(this.graphId);
             this.graphId = null;
@@ -1,7 +1,9 @@
 // WASM-based OfflineAudioContext
 // Drop-in replacement for native OfflineAudioContext using WASM
 
+import { once } from 'events';
 import { WasmAudioEngine } from './WasmAudioEngine.js';
+import { TraceRecorder, TRACE_CAPACITY } from './TraceRecorder.js';
 import { AudioDestinationNode } from '../javascript/nodes/AudioDestinationNode.js';
 import { GainNode } from '../javascript/nodes/GainNode.js';
 import { OscillatorNode } from '../javascript/nodes/OscillatorNode.js';
@@ -50,9 +52,27 @@ export class WasmOfflineAudioContext {
         // Create WASM audio engine (uses singleton WASM module)
         this._engine = new WasmAudioEngine(numberOfChannels, length, sampleRate);
 
+        // Non-standard: { profile: true } records per-node timing for
+        // getGraphProfile(). The graph is freed after rendering, so the profile
+        // is kept here.
+        this._profiling = Boolean(options && options.profile);
+        this._profile = null;
+        if (this._profiling) this._engine.setProfiling(true);
+
+        // Non-standard: { trace: true } records a Chrome trace of the render
+        // for getTrace()
+        this._trace = options && options.trace ? new TraceRecorder() : null;
+        if (this._trace) this._engine.setTracing(TRACE_CAPACITY);
+
         this.state = 'suspended';
         this._rendering = false;
 
+        // Non-standard: onprogress(framesRendered, length) is called every
+        // progressQuanta render quanta (128 frames each) during startRendering().
+        // It runs synchronously inside the WASM render loop.
+        this.onprogress = null;
+        this.progressQuanta = (options && options.progressQuanta) || 1024;
+
         // Create destination node and listener
         const destNodeId = this._engine.createNode('destination');
         this.destination = new AudioDestinationNode(this, destNodeId);
@@ -159,22 +179,16 @@ export class WasmOfflineAudioContext {
         this.state = 'running';
 
         try {
-            // Render audio using WASM engine (returns planar/de-interleaved data)
-            const audioData = await this._engine.render();
+            // Render audio using WASM engine (one Float32Array per channel)
+            const channels = await this._engine.render(this.onprogress, this.progressQuanta);
 
-            // Create AudioBuffer with the rendered data
+            // The AudioBuffer adopts the rendered channels as they are
             const audioBuffer = new AudioBuffer({
                 length: this.length,
                 numberOfChannels: this._channels,
                 sampleRate: this.sampleRate
             });
-
-            // Copy already de-interleaved data (planar format: all ch0, then all ch1, etc.)
-            for (let channel = 0; channel < this._channels; channel++) {
-                const channelData = audioBuffer.getChannelData(channel);
-                const offset = channel * this.length;
-                channelData.set(audioData.subarray(offset, offset + this.length));
-            }
+            audioBuffer._setChannels(channels);
 
             this.state = 'closed';
             this._rendering = false;
@@ -188,11 +202,97 @@ export class WasmOfflineAudioContext {
             // Clean up WASM resources after rendering (success or failure)
             // This frees all malloc'd memory from the graph
             if (this._engine && this._engine.graphId !== null) {
+                if (this._profiling) this._profile = this._engine.getGraphProfile();
+                if (this._trace) this._trace.add(this._engine.takeTrace());
+                this._engine.destroy();
+            }
+        }
+    }
+
+    // Non-standard: render the context's length in chunks of chunkFrames (a
+    // positive integer, default one second) and push each one to `sink` as it
+    // is produced, instead of building one AudioBuffer. Memory use is that of
+    // one chunk, however long the render.
+    //
+    // `sink` is either a function called as sink(chunk, framesRendered) with an
+    // interleaved Float32Array that is reused for the next chunk (return a
+    // promise to apply backpressure), or a Node Writable, which is written
+    // interleaved float32 PCM bytes, waited on for 'drain', and ended afterwards
+    // unless `end` is false. Resolves to the number of frames rendered.
+    async startStreaming(sink, { chunkFrames = this.sampleRate, end = true } = {}) {
+        if (this._rendering) {
+            throw new Error('Rendering is already in progress');
+        }
+        if (!Number.isInteger(chunkFrames) || chunkFrames <= 0) {
+            throw new RangeError(`chunkFrames must be a positive integer, got ${chunkFrames}`);
+        }
+
+        let write;
+        if (typeof sink === 'function') {
+            write = sink;
+        } else if (sink && typeof sink.write === 'function') {
+            write = async chunk => {
+                // The stream may hold on to what it is given: hand it a copy of
+                // the reused chunk.
+                const bytes = Buffer.from(
+                    chunk.buffer.slice(chunk.byteOffset, chunk.byteOffset + chunk.byteLength)
+                );
+                if (!sink.write(bytes)) {
+                    await once(sink, 'drain');
+                }
+            };
+        } else {
+            throw new TypeError('sink must be a function or a writable stream');
+        }
+
+        this._rendering = true;
+        this.state = 'running';
+
+        try {
+            await this._engine.renderStream(async (chunk, framesRendered) => {
+                // Collect trace events as we go: a long stream would fill the
+                // native log otherwise
+                if (this._trace) this._trace.add(this._engine.takeTrace());
+                await write(chunk, framesRendered);
+                if (this.onprogress) this.onprogress(framesRendered, this.length);
+            }, chunkFrames);
+
+            if (end && typeof sink.end === 'function') {
+                sink.end();
+            }
+
+            this.state = 'closed';
+            this._rendering = false;
+            return this.length;
+        } catch (error) {
+            this._rendering = false;
+            this.state = 'suspended';
+            throw error;
+        } finally {
+            if (this._engine && this._engine.graphId !== null) {
+                if (this._profiling) this._profile = this._engine.getGraphProfile();
+                if (this._trace) this._trace.add(this._engine.takeTrace());
                 this._engine.destroy();
             }
         }
     }
 
+    // Non-standard: the render as a Chrome Trace Event JSON object (open it
+    // in Perfetto or chrome://tracing) from a context created with
+    // { trace: true }; null otherwise.
+    getTrace() {
+        if (!this._trace) return null;
+        if (this._engine.graphId !== null) this._trace.add(this._engine.takeTrace());
+        return this._trace.toJSON();
+    }
+
+    // Non-standard: per-node timing from a context created with
+    // { profile: true } (see WasmAudioEngine.getGraphProfile); null otherwise.
+    getGraphProfile() {
+        if (!this._profiling) return null;
+        return this._engine.graphId !== null ? this._engine.getGraphProfile() : this._profile;
+    }
+
     // Alias for compatibility
     async resume() {
         return this.startRendering();
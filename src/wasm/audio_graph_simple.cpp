@@ -2,11 +2,16 @@
 // Calls actual SIMD-optimized node processing from separate files
 
 #include <emscripten.h>
+#include <emscripten/heap.h>
 #include <cstring>
 #include <vector>
 #include <map>
 #include <unordered_map>
 #include <cmath>
+#include <cstdlib>
+#include <climits>
+#include <malloc.h>
+#include <algorithm>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -43,7 +48,8 @@ enum ParamID {
     PARAM_POSITION_Z = 26,
     PARAM_ORIENTATION_X = 27,
     PARAM_ORIENTATION_Y = 28,
-    PARAM_ORIENTATION_Z = 29
+    PARAM_ORIENTATION_Z = 29,
+    PARAM_PLAYBACK_RATE = 30
 };
 
 // Simple oscillator implementation with SIMD
@@ -68,6 +74,7 @@ struct IIRFilterNodeState;
 struct ChannelSplitterNodeState;
 struct ChannelMergerNodeState;
 struct MediaStreamSourceNodeState;
+struct WaveTableSet;
 
 extern "C" {
     // Oscillator
@@ -76,23 +83,40 @@ extern "C" {
     void startOscillator(OscillatorNodeState* state, double when);
     void stopOscillator(OscillatorNodeState* state, double when);
     void setOscillatorCurrentTime(OscillatorNodeState* state, double time);
-    void setPeriodicWave(OscillatorNodeState* state, float* wavetable, int size);
+    bool isOscillatorActive(OscillatorNodeState* state);
+    bool isOscillatorFinished(OscillatorNodeState* state, double time);
+    void resetOscillatorNode(OscillatorNodeState* state);
+    void setOscillatorWaveType(OscillatorNodeState* state, int wave_type);
+    WaveTableSet* createPeriodicWaveTables(const float* real, const float* imag, int count, bool normalize);
+    void destroyPeriodicWaveTables(WaveTableSet* set);
+    void setOscillatorWaveTables(OscillatorNodeState* state, const WaveTableSet* tables);
+    const WaveTableSet* getOscillatorWaveTables(OscillatorNodeState* state);
     void processOscillatorNode(OscillatorNodeState* state, float* output, int frame_count, float frequency, float detune);
+    void processOscillatorNodeARate(OscillatorNodeState* state, float* output, int frame_count, const float* frequency, const float* detune);
 
     // Gain
     GainNodeState* createGainNode(int sample_rate, int channels);
     void destroyGainNode(GainNodeState* state);
     void processGainNode(GainNodeState* state, float* input, float* output, int frame_count, float gain, bool has_input);
+    void processGainNodeARate(GainNodeState* state, float* input, float* output, int frame_count, const float* gain);
 
     // BufferSource
     BufferSourceNodeState* createBufferSourceNode(int sample_rate, int channels);
     void destroyBufferSourceNode(BufferSourceNodeState* state);
-    void setBufferSourceBuffer(BufferSourceNodeState* state, float* buffer_data, int buffer_frames, int buffer_channels);
+    void setBufferSourceBuffer(BufferSourceNodeState* state, const float* buffer_data, int buffer_frames, int buffer_channels);
     void startBufferSource(BufferSourceNodeState* state, double when);
     void stopBufferSource(BufferSourceNodeState* state, double when);
     void setBufferSourceLoop(BufferSourceNodeState* state, bool loop);
+    void setBufferSourceLoopStart(BufferSourceNodeState* state, double seconds);
+    void setBufferSourceLoopEnd(BufferSourceNodeState* state, double seconds);
+    void setBufferSourceOffset(BufferSourceNodeState* state, double seconds);
+    void setBufferSourceInterpolation(BufferSourceNodeState* state, int mode);
     void setBufferSourceCurrentTime(BufferSourceNodeState* state, double time);
-    void processBufferSourceNode(BufferSourceNodeState* state, float* output, int frame_count);
+    bool isBufferSourceActive(BufferSourceNodeState* state);
+    bool isBufferSourceFinished(BufferSourceNodeState* state, double time);
+    void resetBufferSourceNode(BufferSourceNodeState* state);
+    void processBufferSourceNode(BufferSourceNodeState* state, float* output, int frame_count, float playback_rate, float detune);
+    void processBufferSourceNodeARate(BufferSourceNodeState* state, float* output, int frame_count, const float* playback_rate, const float* detune);
 
     // BiquadFilter
     BiquadFilterNodeState* createBiquadFilterNode(int sample_rate, int channels, int filter_type);
@@ -101,13 +125,19 @@ extern "C" {
     void setBiquadFilterFrequency(BiquadFilterNodeState* state, float frequency);
     void setBiquadFilterQ(BiquadFilterNodeState* state, float q);
     void setBiquadFilterGain(BiquadFilterNodeState* state, float gain);
+    void setBiquadFilterDetune(BiquadFilterNodeState* state, float detune);
+    int getBiquadFilterTailFrames(BiquadFilterNodeState* state);
     void processBiquadFilterNode(BiquadFilterNodeState* state, float* input, float* output, int frame_count, bool has_input);
+    void processBiquadFilterNodeARate(BiquadFilterNodeState* state, float* input, float* output, int frame_count,
+                                      const float* frequency, const float* q, const float* gain, const float* detune);
 
     // Delay
     DelayNodeState* createDelayNode(int sample_rate, int channels, float max_delay_time);
     void destroyDelayNode(DelayNodeState* state);
     void setDelayTime(DelayNodeState* state, float delay_time);
+    int getDelayTailFrames(DelayNodeState* state);
     void processDelayNode(DelayNodeState* state, float* input, float* output, int frame_count, bool has_input);
+    void processDelayNodeARate(DelayNodeState* state, float* input, float* output, int frame_count, const float* delay_time);
 
     // WaveShaper
     WaveShaperNodeState* createWaveShaperNode(int sample_rate, int channels);
@@ -121,20 +151,24 @@ extern "C" {
     void destroyStereoPannerNode(StereoPannerNodeState* state);
     void setStereoPannerPan(StereoPannerNodeState* state, float pan);
     void processStereoPannerNode(StereoPannerNodeState* state, float* input, float* output, int frame_count, int input_channels, bool has_input);
+    void processStereoPannerNodeARate(StereoPannerNodeState* state, float* input, float* output, int frame_count, int input_channels, const float* pan);
 
     // ConstantSource
     ConstantSourceNodeState* createConstantSourceNode(int sample_rate, int channels);
     void destroyConstantSourceNode(ConstantSourceNodeState* state);
     void startConstantSource(ConstantSourceNodeState* state);
     void stopConstantSource(ConstantSourceNodeState* state);
+    bool isConstantSourcePlaying(ConstantSourceNodeState* state);
     void setConstantSourceOffset(ConstantSourceNodeState* state, float offset);
     void processConstantSourceNode(ConstantSourceNodeState* state, float* output, int frame_count);
+    void processConstantSourceNodeARate(ConstantSourceNodeState* state, float* output, int frame_count, const float* offset);
 
     // Convolver
     ConvolverNodeState* createConvolverNode(int sample_rate, int channels);
     void destroyConvolverNode(ConvolverNodeState* state);
-    void setConvolverBuffer(ConvolverNodeState* state, float* buffer_data, int length, int num_channels);
+    void setConvolverBuffer(ConvolverNodeState* state, const float* buffer_data, int length, int num_channels);
     void setConvolverNormalize(ConvolverNodeState* state, bool normalize);
+    int getConvolverTailFrames(ConvolverNodeState* state);
     void processConvolverNode(ConvolverNodeState* state, float* input, float* output, int frame_count, bool has_input);
 
     // DynamicsCompressor
@@ -145,6 +179,7 @@ extern "C" {
     void setCompressorRatio(DynamicsCompressorNodeState* state, float ratio);
     void setCompressorAttack(DynamicsCompressorNodeState* state, float attack);
     void setCompressorRelease(DynamicsCompressorNodeState* state, float release);
+    int getDynamicsCompressorTailFrames(DynamicsCompressorNodeState* state);
     void processDynamicsCompressorNode(DynamicsCompressorNodeState* state, float* input, float* output, int frame_count, bool has_input);
 
     // Analyser
@@ -154,6 +189,7 @@ extern "C" {
     void setAnalyserMinDecibels(AnalyserNodeState* state, float min_decibels);
     void setAnalyserMaxDecibels(AnalyserNodeState* state, float max_decibels);
     void setAnalyserSmoothingTimeConstant(AnalyserNodeState* state, float smoothing);
+    int getAnalyserTailFrames(AnalyserNodeState* state);
     void processAnalyserNode(AnalyserNodeState* state, float* input, float* output, int frame_count, bool has_input);
     void getAnalyserFloatFrequencyData(AnalyserNodeState* state, float* array, int array_size);
     void getAnalyserFloatTimeDomainData(AnalyserNodeState* state, float* array, int array_size);
@@ -171,11 +207,14 @@ extern "C" {
     void setPannerRolloffFactor(PannerNodeState* state, float rolloff);
     void setPannerConeAngles(PannerNodeState* state, float inner, float outer);
     void setPannerConeOuterGain(PannerNodeState* state, float gain);
+    void setPannerPanningModel(PannerNodeState* state, int model);
+    void setPannerDistanceModel(PannerNodeState* state, int model);
     void processPannerNode(PannerNodeState* state, float* input, float* output, int frame_count, bool has_input);
 
     // IIRFilter
     IIRFilterNodeState* createIIRFilterNode(int sample_rate, int channels, float* feedforward, int feedforward_length, float* feedback, int feedback_length);
     void destroyIIRFilterNode(IIRFilterNodeState* state);
+    int getIIRFilterTailFrames(IIRFilterNodeState* state);
     void processIIRFilterNode(IIRFilterNodeState* state, float* input, float* output, int frame_count, bool has_input);
 
     // ChannelSplitter
@@ -198,7 +237,7 @@ extern "C" {
 
 // Param automation (utils/audio_param.cpp). AudioParamState holds the scheduled
 // automation events; getParamValueAtTime evaluates the value at a given time per
-// the Web Audio rules. These were never wired into the graph (audio_param.cpp
+// the Web Audio rules, renderParamValues one value per frame over a quantum. These were never wired into the graph (audio_param.cpp
 // wasn't even compiled, and scheduleParameterValue was a no-op), so setValueAtTime
 // / linear & exponential ramps / setTarget did nothing — params snapped to their
 // last scheduled value, which silenced multi-point envelopes (e.g. a 0->1->0 gain
@@ -212,78 +251,299 @@ extern "C" {
     void linearRampToValueAtTime(AudioParamState* state, float value, double time);
     void exponentialRampToValueAtTime(AudioParamState* state, float value, double time);
     void setTargetAtTime(AudioParamState* state, float target, double time, double time_constant);
+    void setValueCurveAtTime(AudioParamState* state, const float* values, int length, double time, double duration);
     void cancelScheduledParamValues(AudioParamState* state, double cancel_time);
     float getParamValueAtTime(AudioParamState* state, double time, int sample_rate);
+    int renderParamValues(AudioParamState* state, double start_time, int sample_rate, float* values, int frame_count);
 }
 
-struct NodeState {
-    float frequency;  // oscillator
-    float detune;     // oscillator
-    float gain;       // gain
-    float filter_frequency;  // biquad
-    float filter_q;          // biquad
-    float filter_gain;       // biquad
-    float delay_time;        // delay
-    float pan;               // stereo panner
-    float offset;            // constant source
-
-    // Panner position/orientation, cached per axis.
-    //
-    // setPannerPosition/Orientation take all three components at once, but the
-    // Web Audio API exposes positionX/Y/Z as separate AudioParams. PannerNodeState
-    // is opaque in this translation unit, so the current value cannot be read
-    // back to fill in the other two — they are kept here instead. Defaults match
-    // the spec: position (0,0,0), orientation (1,0,0).
-    float panner_pos_x, panner_pos_y, panner_pos_z;
-    float panner_orient_x, panner_orient_y, panner_orient_z;
-    // setPannerConeAngles takes inner and outer together, same problem.
-    float panner_cone_inner, panner_cone_outer;
-
-    // Automation timelines per automatable param, keyed by ParamID. Lazily created
-    // on the first scheduled event; absent → use the plain float value above.
-    std::map<int, AudioParamState*> param_auto;
-
-    // Pointers to external node states
-    OscillatorNodeState* osc_state;
-    GainNodeState* gain_state;
-    BufferSourceNodeState* buffer_source_state;
-    BiquadFilterNodeState* biquad_state;
-    DelayNodeState* delay_state;
-    WaveShaperNodeState* waveshaper_state;
-    StereoPannerNodeState* stereo_panner_state;
-    ConstantSourceNodeState* constant_source_state;
-    ConvolverNodeState* convolver_state;
-    DynamicsCompressorNodeState* compressor_state;
-    AnalyserNodeState* analyser_state;
-    PannerNodeState* panner_state;
-    IIRFilterNodeState* iir_filter_state;
-    ChannelSplitterNodeState* channel_splitter_state;
-    ChannelMergerNodeState* channel_merger_state;
-    MediaStreamSourceNodeState* media_stream_source_state;
+// Node kinds. A node's kind selects its handle table and its kernel. JS passes
+// these to createNode (NODE_KIND_NAMES in WasmAudioEngine.js is in this order).
+enum NodeKind {
+    NODE_DESTINATION = 0,
+    NODE_OSCILLATOR = 1,
+    NODE_GAIN = 2,
+    NODE_BUFFER_SOURCE = 3,
+    NODE_BIQUAD_FILTER = 4,
+    NODE_DELAY = 5,
+    NODE_WAVE_SHAPER = 6,
+    NODE_STEREO_PANNER = 7,
+    NODE_CONSTANT_SOURCE = 8,
+    NODE_CONVOLVER = 9,
+    NODE_DYNAMICS_COMPRESSOR = 10,
+    NODE_ANALYSER = 11,
+    NODE_PANNER = 12,
+    NODE_IIR_FILTER = 13,
+    NODE_CHANNEL_SPLITTER = 14,
+    NODE_CHANNEL_MERGER = 15,
+    NODE_MEDIA_STREAM_SOURCE = 16,
+    NODE_KIND_COUNT
 };
 
-struct Node {
-    // 0=destination, 1=oscillator, 2=gain, 3=buffer_source, 4=biquad_filter,
-    // 5=delay, 6=wave_shaper, 7=stereo_panner, 8=constant_source, 9=convolver,
-    // 10=dynamics_compressor, 11=analyser, 12=panner, 13=iir_filter,
-    // 14=channel_splitter, 15=channel_merger, 16=media_stream_source
-    int type;
-    NodeState* state;
+// Node attributes that aren't AudioParams, for setNodeProperty - matches
+// PROPERTY_ID_MAP in WasmAudioEngine.js. Enumerated values travel as their
+// index: oscillator type sine/square/sawtooth/triangle, filter type in
+// BiquadFilterNode order, oversample none/2x/4x, panning model equalpower/HRTF,
+// distance model linear/inverse/exponential, buffer source interpolation
+// linear/cubic/sinc.
+enum NodeProperty {
+    PROP_TYPE = 0,                    // OscillatorNode and BiquadFilterNode type
+    PROP_OVERSAMPLE = 1,
+    PROP_NORMALIZE = 2,
+    PROP_FFT_SIZE = 3,
+    PROP_MIN_DECIBELS = 4,
+    PROP_MAX_DECIBELS = 5,
+    PROP_SMOOTHING_TIME_CONSTANT = 6,
+    PROP_PANNING_MODEL = 7,
+    PROP_DISTANCE_MODEL = 8,
+    PROP_INTERPOLATION = 9            // AudioBufferSourceNode resampling
+};
+
+// One param of a node: its plain value (AudioParam.value) and, once anything
+// has been scheduled on it, its automation timeline.
+struct ParamSlot {
+    float value;
+    AudioParamState* automation;
+};
+
+// Params a kind keeps in its table, by slot, with their spec defaults. Panner
+// position/orientation live here too: setPannerPosition/Orientation take all
+// three components at once while the Web Audio API exposes positionX/Y/Z as
+// separate AudioParams, and PannerNodeState is opaque in this translation unit,
+// so the other two components are read back from these slots. Same for the
+// cone angles, which setPannerConeAngles takes together.
+static const int MAX_NODE_PARAMS = 8;
+
+struct NodeKindParams {
+    int count;
+    int ids[MAX_NODE_PARAMS];
+    float defaults[MAX_NODE_PARAMS];
+};
+
+static const NodeKindParams kind_params[NODE_KIND_COUNT] = {
+    {0, {}, {}},                                                    // destination
+    {2, {PARAM_FREQUENCY, PARAM_DETUNE}, {440.0f, 0.0f}},           // oscillator
+    {1, {PARAM_GAIN}, {1.0f}},                                      // gain
+    {2, {PARAM_PLAYBACK_RATE, PARAM_DETUNE}, {1.0f, 0.0f}},         // buffer_source
+    {4, {PARAM_FREQUENCY, PARAM_Q, PARAM_GAIN, PARAM_DETUNE},
+        {350.0f, 1.0f, 0.0f, 0.0f}},                                // biquad_filter
+    {1, {PARAM_DELAY_TIME}, {0.0f}},                                // delay
+    {0, {}, {}},                                                    // wave_shaper
+    {1, {PARAM_PAN}, {0.0f}},                                       // stereo_panner
+    {1, {PARAM_OFFSET}, {1.0f}},                                    // constant_source
+    {0, {}, {}},                                                    // convolver
+    {0, {}, {}},                                                    // dynamics_compressor
+    {0, {}, {}},                                                    // analyser
+    {8, {PARAM_POSITION_X, PARAM_POSITION_Y, PARAM_POSITION_Z,
+         PARAM_ORIENTATION_X, PARAM_ORIENTATION_Y, PARAM_ORIENTATION_Z,
+         PARAM_CONE_INNER_ANGLE, PARAM_CONE_OUTER_ANGLE},
+        {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 360.0f, 360.0f}},     // panner (facing +X, cone disabled)
+    {0, {}, {}},                                                    // iir_filter
+    {0, {}, {}},                                                    // channel_splitter
+    {0, {}, {}},                                                    // channel_merger
+    {0, {}, {}},                                                    // media_stream_source
+};
+
+// Slot of param_id in a node of this kind, or -1 if the kind doesn't keep it.
+static int paramSlot(int kind, int param_id) {
+    const NodeKindParams& kp = kind_params[kind];
+    for (int i = 0; i < kp.count; ++i) {
+        if (kp.ids[i] == param_id) return i;
+    }
+    return -1;
+}
+
+// Node handles. A handle packs the node's kind, its index in that kind's table
+// and the generation of that index:
+//
+//   bits  0-15  index
+//   bits 16-20  kind
+//   bits 21-30  generation (never 0, so no live handle is 0 or negative)
+//
+// Looking a node up is two array reads. The generation is bumped whenever an
+// index is recycled, so a stale handle to a destroyed node fails the check
+// instead of reaching whatever node took its place.
+static const int HANDLE_INDEX_BITS = 16;
+static const int HANDLE_KIND_BITS = 5;
+static const int HANDLE_MAX_INDEX = (1 << HANDLE_INDEX_BITS) - 1;
+static const int HANDLE_MAX_GENERATION = (1 << (31 - HANDLE_INDEX_BITS - HANDLE_KIND_BITS)) - 1;
+
+static inline int makeHandle(int kind, int index, int generation) {
+    return (generation << (HANDLE_INDEX_BITS + HANDLE_KIND_BITS)) | (kind << HANDLE_INDEX_BITS) | index;
+}
+static inline int handleIndex(int handle) { return handle & HANDLE_MAX_INDEX; }
+static inline int handleKind(int handle) { return (handle >> HANDLE_INDEX_BITS) & ((1 << HANDLE_KIND_BITS) - 1); }
+static inline int handleGeneration(int handle) { return handle >> (HANDLE_INDEX_BITS + HANDLE_KIND_BITS); }
+
+// An audio-rate connection into a param (AudioNode.connect(AudioParam)): the
+// output of node `source` is added to param slot `slot` of the node holding it.
+struct ParamInput {
+    int source;
+    int slot;
+};
+
+// All nodes of one kind, struct-of-arrays. The dense columns hold the live
+// nodes contiguously (same kind, same kernel, next to each other in memory);
+// the sparse columns map a handle's index to its dense position.
+struct NodeTable {
+    int kind;
+    int param_count;
+
+    // Dense: entry i is the i-th live node of this kind.
+    std::vector<int> handles;
+    std::vector<void*> kernels;             // OscillatorNodeState* etc., by kind
+    std::vector<ParamSlot> params;          // param_count slots per node
+    std::vector<std::vector<int>> inputs;   // handles of the nodes connected into it
+    std::vector<std::vector<int>> outputs;  // handles of the nodes it feeds
+    std::vector<std::vector<ParamInput>> param_inputs;  // nodes connected into its params
+    std::vector<std::vector<int>> param_outputs;        // handles of the nodes whose params it feeds
+    std::vector<int> silent_frames;         // frames since its input last carried sound
+
+    // Sparse, by handle index: dense position (-1 if free) and generation.
+    std::vector<int> dense_of;
+    std::vector<uint16_t> generations;
+    std::vector<int> free_indices;
 };
 
-struct BufferData {
-    float* data;
+static inline ParamSlot* nodeParams(NodeTable& table, int dense) {
+    return table.params.data() + static_cast<size_t>(dense) * table.param_count;
+}
+
+// PCM of an AudioBuffer in the graph's sample store: written into WASM memory
+// once by JS, then played in place by every buffer source using it. Freed when
+// its registration and all of those sources have let go.
+struct SampleData {
+    float* data;   // interleaved frames, from malloc
     int frames;
     int channels;
+    int refs;
 };
 
+static void releaseSample(SampleData* sample) {
+    if (!sample || --sample->refs > 0) return;
+    free(sample->data);
+    delete sample;
+}
+
+// Band-limited tables of one PeriodicWave, shared by the oscillators playing it
+// and freed when the last of them lets go.
+struct PeriodicWaveEntry {
+    WaveTableSet* tables;
+    std::vector<float> real;
+    std::vector<float> imag;
+    bool normalize;
+    int refs;
+};
+
+// The graph renders in quanta of this many frames, whatever block size the
+// caller asks processGraph for. Render buffers are sized for one quantum.
+static const int RENDER_QUANTUM = 128;
+
+// A param with nodes connected into it: each quantum their output, down-mixed
+// to mono, is added frame by frame to the param's own value.
+struct ParamBus {
+    int slot;                   // param slot in the node
+    std::vector<int> steps;     // schedule indices of the nodes feeding it
+    std::vector<float*> sources;
+};
+
+// One step of the compiled render schedule. Everything the render loop needs to
+// run a node is resolved here when the graph changes, so a quantum never has to
+// look a node up by id or recurse through connections.
+struct ScheduledNode {
+    int node_id;
+    int type;
+    int dense;                // position in graph->tables[type]
+    std::vector<int> inputs;  // schedule indices of the steps feeding this one
+
+    // Render buffers, resolved into the graph's arena by compileSchedule.
+    // `output` is this step's slot (nullptr for the destination, which writes
+    // into processGraph's buffer). `input` is what the kernel reads: an upstream
+    // slot directly when there is a single input, otherwise the buffer the
+    // inputs are summed into.
+    float* output = nullptr;
+    float* input = nullptr;
+    std::vector<float*> mix_sources;  // summed into `input` each quantum
+    std::vector<int> mix_steps;       // the step that writes each of mix_sources
+    int accumulated_step = -1;        // input step whose slot `input` is, or -1
+
+    // Params with audio-rate inputs, the steps feeding them, and those steps'
+    // slots (resolved with the other render buffers).
+    std::vector<ParamBus> param_buses;
+};
+
+// Real-time render timing behind renderCapacity: wall time spent in
+// processGraph against the audio time it produced, since the last read.
+struct RenderStats {
+    double render_ms = 0.0;  // time spent rendering
+    double audio_ms = 0.0;   // audio time rendered
+    double peak_load = 0.0;  // highest render/audio ratio of a single call
+    int calls = 0;
+};
+
+// Opt-in per-node profile (setGraphProfiling): process calls, time spent in
+// them, and heap bytes the node took, at creation or while processing.
+struct NodeProfile {
+    int kind = 0;
+    uint64_t calls = 0;
+    double total_ms = 0.0;
+    double max_ms = 0.0;
+    double bytes = 0.0;
+};
+
+// Row layout of getGraphProfile: handle, kind, calls, total ms, max ms, bytes.
+// Node rows come first, then one row per node kind (handle 0), then the graph
+// overhead (handle and kind -1): quantum time not spent inside any node.
+static const int PROFILE_FIELDS = 6;
+
+// Bytes the heap has handed out and not taken back, from its own statistics,
+// so every kind of allocation is seen. A profiled node is charged the growth
+// across its creation and process calls. mallinfo walks the heap, so this is
+// only read while profiling; see sampleHeap.
+static double heapBytesInUse() {
+    return static_cast<double>(mallinfo().uordblks);
+}
+
+// Trace recording (setGraphTracing) for Chrome Trace Event export. Times are
+// emscripten_get_now() milliseconds. Instants carry the graph time they take
+// effect at in `when`.
+enum TracePhase {
+    TRACE_NODE = 0,      // slice: one node's process call
+    TRACE_QUANTUM = 1,   // slice: one render quantum; value = frames
+    TRACE_START = 2,     // instant: startNode
+    TRACE_STOP = 3,      // instant: stopNode
+    TRACE_PARAM = 4,     // instant: setNodeParameter / scheduleParamEvent; value = target
+    TRACE_HEAP = 5       // counter: WASM heap size in bytes
+};
+
+struct TraceEvent {
+    int phase;
+    int handle;
+    int param;
+    double ts;
+    double dur;
+    double when;
+    double value;
+};
+
+// Row layout of takeGraphTrace: phase, handle, kind, param, ts, dur, when, value.
+static const int TRACE_FIELDS = 8;
+
 struct AudioGraph {
     int sample_rate;
     int channels;
-    std::unordered_map<int, Node> nodes;
-    std::unordered_map<int, std::vector<int>> connections; // dest_id -> list of source_ids
-    std::unordered_map<int, BufferData> buffers; // buffer_id -> buffer data
-    int next_id;
+    NodeTable tables[NODE_KIND_COUNT];  // one handle table per node kind
+
+    // Nodes JS no longer references (releaseNode). Checked at the end of every
+    // quantum and freed once they can't be heard any more.
+    std::vector<int> released_nodes;
+
+    // Kernel states of reclaimed one-shot sources, reset and ready for the
+    // next createNode of the same kind.
+    std::vector<void*> kernel_pool[NODE_KIND_COUNT];
+    std::unordered_map<int, SampleData*> samples;       // buffer_id -> registered PCM
+    std::unordered_map<int, SampleData*> node_samples;  // by handle: PCM a buffer source plays
+    std::unordered_multimap<uint64_t, PeriodicWaveEntry> periodic_waves;  // by coefficient hash
     int dest_id;
     uint64_t current_sample; // Track current sample for timing
     bool is_realtime; // True for AudioContext (JS manages time), false for OfflineAudioContext (WASM manages time)
@@ -292,19 +552,483 @@ struct AudioGraph {
     uint64_t realtime_start_sample;  // Sample offset when timing was first queried
     bool realtime_time_initialized;  // Whether start offset has been captured
 
-    // Pre-allocated buffers for graph processing (eliminates malloc overhead)
-    std::vector<float> temp_buffer; // Reusable temp buffer for mixing
-    std::vector<float> mix_buffer; // Separate buffer for gain node mixing (prevents recursion conflicts)
-
-    // Cached node outputs (prevents reprocessing within same frame)
-    // Using unordered_map for O(1) lookups instead of O(log n)
-    std::unordered_map<int, std::vector<float>> node_buffers;
-    int current_frame_count; // Track buffer size for reallocation checks
+    RenderStats render_stats;
+
+    // Profiling (off unless setGraphProfiling turns it on)
+    bool profiling;
+    std::unordered_map<int, NodeProfile> node_profiles;  // by handle
+    NodeProfile overhead_profile;
+    double quantum_node_ms;            // node time within the current quantum
+    double heap_sample_ms;             // time spent in sampleHeap, ever
+    std::vector<double> profile_rows;  // getGraphProfile's result
+
+    // Tracing: events since the last takeGraphTrace, up to trace_capacity;
+    // later ones are counted in trace_dropped.
+    bool tracing;
+    size_t trace_capacity;
+    double trace_dropped;
+    double trace_heap_bytes;          // last heap size recorded
+    std::vector<TraceEvent> trace_events;
+    std::vector<double> trace_rows;   // takeGraphTrace's result
+
+    // Compiled render schedule: the nodes reachable from the destination in
+    // topological order (destination last). Rebuilt lazily at the start of the
+    // next processGraph whenever createNode/connectNodes/disconnectNodes mark it
+    // dirty, then rendered as one linear walk per quantum.
+    std::vector<ScheduledNode> schedule;
+    bool schedule_dirty;
+
+    // Per schedule step, whether it was skipped as silent this quantum. A
+    // silent step leaves its slot unwritten; readers treat it as zeros and
+    // leave it out of their mix.
+    std::vector<uint8_t> step_silent;
+
+    // Render buffer arena: one 16-byte aligned block of quantum-sized slots.
+    // Slot 0 is mix scratch and slot 1 (`silence`) stays all zeros, the input
+    // of a node whose inputs are silent but which still has a tail to play.
+    // The rest are handed out to schedule steps by liveness, so a slot is
+    // reused as soon as the last reader of the step that wrote it has run.
+    float* arena;
+    float* silence;
+    int arena_slots;
+    int slot_floats;
+
+    // Per-frame param values of the node being processed, when any of its
+    // params has an audio-rate input: one row per param slot.
+    float param_rates[MAX_NODE_PARAMS][RENDER_QUANTUM];
 };
 
+// heapBytesInUse, with the time it takes added to heap_sample_ms. Timed
+// regions that contain samples subtract that time, so the profiler's own heap
+// walks don't show up as graph overhead, quantum time or render load.
+static double sampleHeap(AudioGraph* graph) {
+    const double start = emscripten_get_now();
+    const double bytes = heapBytesInUse();
+    graph->heap_sample_ms += emscripten_get_now() - start;
+    return bytes;
+}
+
 static std::unordered_map<int, AudioGraph*> graphs;
 static int next_graph_id = 1;
 
+static void traceEvent(AudioGraph* graph, int phase, int handle, int param, double ts, double dur,
+                       double when, double value) {
+    if (graph->trace_events.size() >= graph->trace_capacity) {
+        graph->trace_dropped++;
+        return;
+    }
+    graph->trace_events.push_back({phase, handle, param, ts, dur, when, value});
+}
+
+// Add a node to its kind's table. Returns its handle, or 0 when the table is
+// out of indices.
+static int tableInsert(NodeTable& table, void* kernel) {
+    int index;
+    if (!table.free_indices.empty()) {
+        index = table.free_indices.back();
+        table.free_indices.pop_back();
+    } else {
+        if (static_cast<int>(table.dense_of.size()) > HANDLE_MAX_INDEX) return 0;
+        index = static_cast<int>(table.dense_of.size());
+        table.dense_of.push_back(-1);
+        table.generations.push_back(1);
+    }
+
+    int handle = makeHandle(table.kind, index, table.generations[index]);
+    table.dense_of[index] = static_cast<int>(table.handles.size());
+    table.handles.push_back(handle);
+    table.kernels.push_back(kernel);
+    table.inputs.emplace_back();
+    table.outputs.emplace_back();
+    table.param_inputs.emplace_back();
+    table.param_outputs.emplace_back();
+    table.silent_frames.push_back(INT_MAX);  // never fed: nothing to ring out
+
+    const NodeKindParams& kp = kind_params[table.kind];
+    for (int i = 0; i < kp.count; ++i) {
+        table.params.push_back({kp.defaults[i], nullptr});
+    }
+    return handle;
+}
+
+// Resolve a handle to its table and dense position. nullptr for handles that
+// are malformed, from another kind's range, or stale.
+static NodeTable* findNode(AudioGraph* graph, int handle, int& dense) {
+    if (handle <= 0) return nullptr;
+    int kind = handleKind(handle);
+    if (kind >= NODE_KIND_COUNT) return nullptr;
+
+    NodeTable& table = graph->tables[kind];
+    int index = handleIndex(handle);
+    if (index >= static_cast<int>(table.dense_of.size())) return nullptr;
+    if (table.generations[index] != handleGeneration(handle) || table.dense_of[index] < 0) return nullptr;
+
+    dense = table.dense_of[index];
+    return &table;
+}
+
+// Remove the node at `dense` from its table: the last node moves into its place
+// so the dense columns stay packed, and the handle's index goes back on the free
+// list under a new generation.
+static void tableRemove(NodeTable& table, int dense) {
+    const int index = handleIndex(table.handles[dense]);
+    const int last = static_cast<int>(table.handles.size()) - 1;
+
+    if (dense != last) {
+        table.handles[dense] = table.handles[last];
+        table.kernels[dense] = table.kernels[last];
+        std::copy(nodeParams(table, last), nodeParams(table, last) + table.param_count, nodeParams(table, dense));
+        table.inputs[dense].swap(table.inputs[last]);
+        table.outputs[dense].swap(table.outputs[last]);
+        table.param_inputs[dense].swap(table.param_inputs[last]);
+        table.param_outputs[dense].swap(table.param_outputs[last]);
+        table.silent_frames[dense] = table.silent_frames[last];
+        table.dense_of[handleIndex(table.handles[dense])] = dense;
+    }
+    table.handles.pop_back();
+    table.kernels.pop_back();
+    table.params.resize(static_cast<size_t>(last) * table.param_count);
+    table.inputs.pop_back();
+    table.outputs.pop_back();
+    table.param_inputs.pop_back();
+    table.param_outputs.pop_back();
+    table.silent_frames.pop_back();
+
+    table.dense_of[index] = -1;
+    uint16_t& generation = table.generations[index];
+    generation = generation == HANDLE_MAX_GENERATION ? 1 : generation + 1;
+    table.free_indices.push_back(index);
+}
+
+// Create the kernel state for a new node of this kind, reusing a pooled one if
+// a reclaimed node left one behind.
+static void* createKernel(AudioGraph* graph, int kind) {
+    std::vector<void*>& pool = graph->kernel_pool[kind];
+    if (!pool.empty()) {
+        void* kernel = pool.back();
+        pool.pop_back();
+        return kernel;
+    }
+
+    switch (kind) {
+        case NODE_OSCILLATOR:
+            // Web Audio spec default is sine (0); the OscillatorNode setter pushes the
+            // requested type anyway, but make the unset default correct too.
+            return createOscillatorNode(graph->sample_rate, graph->channels, 0);
+        case NODE_GAIN:
+            return createGainNode(graph->sample_rate, graph->channels);
+        case NODE_BUFFER_SOURCE:
+            return createBufferSourceNode(graph->sample_rate, graph->channels);
+        case NODE_BIQUAD_FILTER:
+            return createBiquadFilterNode(graph->sample_rate, graph->channels, 0); // 0 = LOWPASS
+        case NODE_DELAY:
+            return createDelayNode(graph->sample_rate, graph->channels, 1.0f);
+        case NODE_WAVE_SHAPER:
+            return createWaveShaperNode(graph->sample_rate, graph->channels);
+        case NODE_STEREO_PANNER:
+            return createStereoPannerNode(graph->sample_rate);
+        case NODE_CONSTANT_SOURCE:
+            return createConstantSourceNode(graph->sample_rate, graph->channels);
+        case NODE_CONVOLVER:
+            return createConvolverNode(graph->sample_rate, graph->channels);
+        case NODE_DYNAMICS_COMPRESSOR:
+            return createDynamicsCompressorNode(graph->sample_rate, graph->channels);
+        case NODE_ANALYSER:
+            return createAnalyserNode(graph->sample_rate, graph->channels);
+        case NODE_PANNER:
+            return createPannerNode(graph->sample_rate, graph->channels);
+        case NODE_IIR_FILTER: {
+            // IIR filter requires coefficients - will be set later via setIIRFilterCoefficients
+            // Default: simple pass-through (b=[1], a=[1])
+            float b[] = {1.0f};
+            float a[] = {1.0f};
+            return createIIRFilterNode(graph->sample_rate, graph->channels, b, 1, a, 1);
+        }
+        case NODE_CHANNEL_SPLITTER:
+            return createChannelSplitterNode(graph->sample_rate, graph->channels);
+        case NODE_CHANNEL_MERGER:
+            return createChannelMergerNode(graph->sample_rate, graph->channels);
+        default:
+            // Destination has no kernel. MediaStreamSourceNodeState is created on the
+            // JS side and attached via setMediaStreamSourceState().
+            return nullptr;
+    }
+}
+
+static void destroyKernel(int kind, void* kernel) {
+    if (!kernel) return;
+    switch (kind) {
+        case NODE_OSCILLATOR: destroyOscillatorNode(static_cast<OscillatorNodeState*>(kernel)); break;
+        case NODE_GAIN: destroyGainNode(static_cast<GainNodeState*>(kernel)); break;
+        case NODE_BUFFER_SOURCE: destroyBufferSourceNode(static_cast<BufferSourceNodeState*>(kernel)); break;
+        case NODE_BIQUAD_FILTER: destroyBiquadFilterNode(static_cast<BiquadFilterNodeState*>(kernel)); break;
+        case NODE_DELAY: destroyDelayNode(static_cast<DelayNodeState*>(kernel)); break;
+        case NODE_WAVE_SHAPER: destroyWaveShaperNode(static_cast<WaveShaperNodeState*>(kernel)); break;
+        case NODE_STEREO_PANNER: destroyStereoPannerNode(static_cast<StereoPannerNodeState*>(kernel)); break;
+        case NODE_CONSTANT_SOURCE: destroyConstantSourceNode(static_cast<ConstantSourceNodeState*>(kernel)); break;
+        case NODE_CONVOLVER: destroyConvolverNode(static_cast<ConvolverNodeState*>(kernel)); break;
+        case NODE_DYNAMICS_COMPRESSOR: destroyDynamicsCompressorNode(static_cast<DynamicsCompressorNodeState*>(kernel)); break;
+        case NODE_ANALYSER: destroyAnalyserNode(static_cast<AnalyserNodeState*>(kernel)); break;
+        case NODE_PANNER: destroyPannerNode(static_cast<PannerNodeState*>(kernel)); break;
+        case NODE_IIR_FILTER: destroyIIRFilterNode(static_cast<IIRFilterNodeState*>(kernel)); break;
+        case NODE_CHANNEL_SPLITTER: destroyChannelSplitterNode(static_cast<ChannelSplitterNodeState*>(kernel)); break;
+        case NODE_CHANNEL_MERGER: destroyChannelMergerNode(static_cast<ChannelMergerNodeState*>(kernel)); break;
+        default: break;  // media stream state is owned by its JS node
+    }
+}
+
+// Point a buffer source or convolver at a stored sample. A buffer source plays
+// the PCM in place and holds a reference to it until it is given another
+// buffer or removed; a convolver only reads it to build its spectrum.
+static void useSample(AudioGraph* graph, int handle, NodeTable& table, int dense, SampleData* sample) {
+    void* kernel = table.kernels[dense];
+    if (!kernel) return;
+
+    if (table.kind == NODE_BUFFER_SOURCE) {
+        sample->refs++;
+        SampleData*& held = graph->node_samples[handle];
+        releaseSample(held);
+        held = sample;
+        setBufferSourceBuffer(static_cast<BufferSourceNodeState*>(kernel), sample->data, sample->frames, sample->channels);
+    } else if (table.kind == NODE_CONVOLVER) {
+        setConvolverBuffer(static_cast<ConvolverNodeState*>(kernel), sample->data, sample->frames, sample->channels);
+    }
+}
+
+// FNV-1a over the coefficients and the normalization flag
+static uint64_t hashPeriodicWave(const float* real, const float* imag, int count, bool normalize) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(&normalize, sizeof normalize);
+    mix(real, count * sizeof(float));
+    mix(imag, count * sizeof(float));
+    return hash;
+}
+
+// Tables for these coefficients: the cached set if some oscillator already
+// plays them, built otherwise. Each call takes a reference.
+static WaveTableSet* acquirePeriodicWave(AudioGraph* graph, const float* real, const float* imag, int count,
+                                         bool normalize) {
+    // Trailing zero harmonics don't change the wave, so they don't make a new one
+    while (count > 2 && real[count - 1] == 0.0f && imag[count - 1] == 0.0f) --count;
+
+    const uint64_t hash = hashPeriodicWave(real, imag, count, normalize);
+    auto range = graph->periodic_waves.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        PeriodicWaveEntry& entry = it->second;
+        if (entry.normalize == normalize && entry.real.size() == static_cast<size_t>(count) &&
+            std::equal(real, real + count, entry.real.begin()) &&
+            std::equal(imag, imag + count, entry.imag.begin())) {
+            entry.refs++;
+            return entry.tables;
+        }
+    }
+
+    WaveTableSet* tables = createPeriodicWaveTables(real, imag, count, normalize);
+    if (!tables) return nullptr;
+    PeriodicWaveEntry entry;
+    entry.tables = tables;
+    entry.real.assign(real, real + count);
+    entry.imag.assign(imag, imag + count);
+    entry.normalize = normalize;
+    entry.refs = 1;
+    graph->periodic_waves.emplace(hash, std::move(entry));
+    return tables;
+}
+
+// Drop an oscillator's reference to its custom tables
+static void releasePeriodicWave(AudioGraph* graph, const WaveTableSet* tables) {
+    if (!tables) return;
+    for (auto it = graph->periodic_waves.begin(); it != graph->periodic_waves.end(); ++it) {
+        if (it->second.tables != tables) continue;
+        if (--it->second.refs == 0) {
+            destroyPeriodicWaveTables(it->second.tables);
+            graph->periodic_waves.erase(it);
+        }
+        return;
+    }
+}
+
+// Most reclaimed kernels a graph keeps per kind for reuse.
+static const size_t KERNEL_POOL_LIMIT = 64;
+
+// Dispose of a removed node's kernel. One-shot sources are what games create
+// and drop by the hundred, so those are reset and pooled; everything else is
+// freed.
+static void recycleKernel(AudioGraph* graph, int kind, void* kernel) {
+    if (!kernel) return;
+
+    if (kind == NODE_OSCILLATOR) {
+        releasePeriodicWave(graph, getOscillatorWaveTables(static_cast<OscillatorNodeState*>(kernel)));
+    }
+
+    std::vector<void*>& pool = graph->kernel_pool[kind];
+    if (pool.size() < KERNEL_POOL_LIMIT) {
+        if (kind == NODE_OSCILLATOR) {
+            resetOscillatorNode(static_cast<OscillatorNodeState*>(kernel));
+            pool.push_back(kernel);
+            return;
+        }
+        if (kind == NODE_BUFFER_SOURCE) {
+            resetBufferSourceNode(static_cast<BufferSourceNodeState*>(kernel));
+            pool.push_back(kernel);
+            return;
+        }
+    }
+    destroyKernel(kind, kernel);
+}
+
+// Seconds on the graph's timeline: relative to the first render for real-time
+// contexts (same logic as getGraphCurrentTime), absolute for offline ones.
+static double graphTime(const AudioGraph* graph) {
+    if (graph->is_realtime && graph->realtime_time_initialized) {
+        return static_cast<double>(graph->current_sample - graph->realtime_start_sample)
+             / static_cast<double>(graph->sample_rate);
+    }
+    return static_cast<double>(graph->current_sample) / static_cast<double>(graph->sample_rate);
+}
+
+// Unlink a node from everything it is connected to and free it.
+static void removeNode(AudioGraph* graph, NodeTable& table, int dense) {
+    const int handle = table.handles[dense];
+
+    for (int dest_id : table.outputs[dense]) {
+        int dest_dense;
+        NodeTable* dest = findNode(graph, dest_id, dest_dense);
+        if (!dest) continue;
+        std::vector<int>& sources = dest->inputs[dest_dense];
+        sources.erase(std::remove(sources.begin(), sources.end(), handle), sources.end());
+    }
+    for (int source_id : table.inputs[dense]) {
+        int source_dense;
+        NodeTable* source = findNode(graph, source_id, source_dense);
+        if (!source) continue;
+        std::vector<int>& dests = source->outputs[source_dense];
+        dests.erase(std::remove(dests.begin(), dests.end(), handle), dests.end());
+    }
+    for (int dest_id : table.param_outputs[dense]) {
+        int dest_dense;
+        NodeTable* dest = findNode(graph, dest_id, dest_dense);
+        if (!dest) continue;
+        std::vector<ParamInput>& inputs = dest->param_inputs[dest_dense];
+        inputs.erase(std::remove_if(inputs.begin(), inputs.end(),
+                                    [handle](const ParamInput& in) { return in.source == handle; }),
+                     inputs.end());
+    }
+    for (const ParamInput& in : table.param_inputs[dense]) {
+        int source_dense;
+        NodeTable* source = findNode(graph, in.source, source_dense);
+        if (!source) continue;
+        std::vector<int>& dests = source->param_outputs[source_dense];
+        dests.erase(std::remove(dests.begin(), dests.end(), handle), dests.end());
+    }
+
+    ParamSlot* params = nodeParams(table, dense);
+    for (int i = 0; i < table.param_count; ++i) {
+        if (params[i].automation) destroyAudioParam(params[i].automation);
+    }
+    auto held = graph->node_samples.find(handle);
+    if (held != graph->node_samples.end()) {
+        releaseSample(held->second);
+        graph->node_samples.erase(held);
+    }
+    recycleKernel(graph, table.kind, table.kernels[dense]);
+    tableRemove(table, dense);
+    graph->schedule_dirty = true;
+}
+
+// Whether a released node can go now. One-shot sources go once they have
+// finished. Stateless processors go once nothing feeds them, which lets a
+// released source -> gain -> panner chain unwind link by link. Filters, delays,
+// convolvers and compressors are kept: with their inputs gone they still ring
+// out a tail, and cutting it would be audible. Constant and media stream sources
+// have no end of their own and are only removed by destroyNode.
+static bool isReclaimable(NodeTable& table, int dense, double time) {
+    void* kernel = table.kernels[dense];
+    switch (table.kind) {
+        case NODE_OSCILLATOR:
+            return isOscillatorFinished(static_cast<OscillatorNodeState*>(kernel), time);
+        case NODE_BUFFER_SOURCE:
+            return isBufferSourceFinished(static_cast<BufferSourceNodeState*>(kernel), time);
+        case NODE_GAIN:
+        case NODE_WAVE_SHAPER:
+        case NODE_STEREO_PANNER:
+        case NODE_ANALYSER:
+        case NODE_PANNER:
+        case NODE_CHANNEL_SPLITTER:
+        case NODE_CHANNEL_MERGER:
+            return table.inputs[dense].empty();
+        default:
+            return false;
+    }
+}
+
+// Free the released nodes that can't be heard any more. Runs after each quantum.
+static void reclaimReleasedNodes(AudioGraph* graph) {
+    const double time = graphTime(graph);
+    std::vector<int>& released = graph->released_nodes;
+
+    // Removing a node can leave a released node downstream with no inputs, so
+    // go round again until a pass frees nothing.
+    bool removed = true;
+    while (removed) {
+        removed = false;
+        for (size_t i = 0; i < released.size();) {
+            int dense;
+            NodeTable* table = findNode(graph, released[i], dense);
+            if (table && !isReclaimable(*table, dense, time)) {
+                ++i;
+                continue;
+            }
+            if (table) {
+                removeNode(graph, *table, dense);
+                removed = true;
+            }
+            released[i] = released.back();
+            released.pop_back();
+        }
+    }
+}
+
+// Opcodes of the command buffer read by applyCommands. Each command is a u32
+// opcode followed by its fields, little-endian and packed (no padding):
+enum GraphCommand {
+    CMD_SET_PARAM = 1,       // i32 node, i32 param, f32 value
+    CMD_SCHEDULE_PARAM = 2,  // i32 node, i32 param, i32 kind, f32 value, f64 time, f32 time constant
+    CMD_START = 3,           // i32 node, f64 when
+    CMD_STOP = 4,            // i32 node, f64 when
+    CMD_CONNECT = 5,         // i32 source, i32 dest, i32 output, i32 input
+    CMD_DISCONNECT = 6,      // i32 source, i32 dest (-1: every destination)
+    CMD_RELEASE = 7,         // i32 node
+    CMD_DESTROY = 8,         // i32 node
+    CMD_SET_BUFFER_ID = 9,   // i32 node, i32 buffer id
+    CMD_SET_PROPERTY = 10,   // i32 node, i32 property, f32 value
+    CMD_CONNECT_PARAM = 11,  // i32 source, i32 dest, i32 param, i32 output
+    CMD_DISCONNECT_PARAM = 12  // i32 source, i32 dest, i32 param
+};
+
+// Sequential reader over a command buffer. Fields may be unaligned, so each
+// is copied out.
+struct CommandReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+
+    bool has(size_t bytes) const { return static_cast<size_t>(end - pos) >= bytes; }
+    template <typename T>
+    T read() {
+        T value;
+        memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+};
+
 extern "C" {
 
 EMSCRIPTEN_KEEPALIVE
@@ -312,29 +1036,36 @@ int createAudioGraph(int sample_rate, int channels, int buffer_size, bool is_rea
     AudioGraph* graph = new AudioGraph();
     graph->sample_rate = sample_rate;
     graph->channels = channels;
-    graph->next_id = 1;
     graph->current_sample = 0;
     graph->is_realtime = is_realtime;
     graph->realtime_start_sample = 0;
     graph->realtime_time_initialized = false;
-
-    // Pre-allocate processing buffers (assume max 128 frames for Web Audio quantum).
-    // BOTH temp_buffer AND mix_buffer must be sized — mix_buffer is the scratch for
-    // the source->gain->destination path (processNode type-2 branch). It was left
-    // empty here and the resize in processGraph only ran when frame_count changed
-    // from 128 (which it never does), so it stayed size 0 and writing a
-    // buffer-source-through-gain into mix_buffer.data() overran -> SIGSEGV.
-    graph->current_frame_count = 128;
-    graph->temp_buffer.resize(128 * channels);
-    graph->mix_buffer.resize(128 * channels);
+    graph->render_stats = RenderStats();
+    graph->profiling = false;
+    graph->overhead_profile.kind = -1;
+    graph->quantum_node_ms = 0.0;
+    graph->heap_sample_ms = 0.0;
+    graph->tracing = false;
+    graph->trace_capacity = 0;
+    graph->trace_dropped = 0.0;
+    graph->trace_heap_bytes = 0.0;
+
+    // The arena is allocated when the schedule is compiled. Stereo panner always
+    // writes two channels, even into a mono graph, so never size a slot below
+    // stereo.
+    graph->arena = nullptr;
+    graph->silence = nullptr;
+    graph->arena_slots = 0;
+    graph->slot_floats = RENDER_QUANTUM * (channels < 2 ? 2 : channels);
+    graph->schedule_dirty = true;
+
+    for (int kind = 0; kind < NODE_KIND_COUNT; ++kind) {
+        graph->tables[kind].kind = kind;
+        graph->tables[kind].param_count = kind_params[kind].count;
+    }
 
     // Create destination
-    Node dest;
-    dest.type = 0;
-    dest.state = nullptr;
-    graph->nodes[graph->next_id] = dest;
-    graph->dest_id = graph->next_id;
-    graph->next_id++;
+    graph->dest_id = tableInsert(graph->tables[NODE_DESTINATION], nullptr);
 
     int graph_id = next_graph_id++;
     graphs[graph_id] = graph;
@@ -347,189 +1078,62 @@ void destroyAudioGraph(int graph_id) {
     if (it != graphs.end()) {
         AudioGraph* graph = it->second;
 
-        // Free all node states
-        for (auto& pair : graph->nodes) {
-            Node& node = pair.second;
-            if (node.state) {
-                // Destroy external node states
-                if (node.state->osc_state) destroyOscillatorNode(node.state->osc_state);
-                if (node.state->gain_state) destroyGainNode(node.state->gain_state);
-                if (node.state->buffer_source_state) destroyBufferSourceNode(node.state->buffer_source_state);
-                if (node.state->biquad_state) destroyBiquadFilterNode(node.state->biquad_state);
-                if (node.state->delay_state) destroyDelayNode(node.state->delay_state);
-                if (node.state->waveshaper_state) destroyWaveShaperNode(node.state->waveshaper_state);
-                if (node.state->stereo_panner_state) destroyStereoPannerNode(node.state->stereo_panner_state);
-                if (node.state->constant_source_state) destroyConstantSourceNode(node.state->constant_source_state);
-                if (node.state->convolver_state) destroyConvolverNode(node.state->convolver_state);
-                if (node.state->compressor_state) destroyDynamicsCompressorNode(node.state->compressor_state);
-                if (node.state->analyser_state) destroyAnalyserNode(node.state->analyser_state);
-                if (node.state->panner_state) destroyPannerNode(node.state->panner_state);
-                if (node.state->iir_filter_state) destroyIIRFilterNode(node.state->iir_filter_state);
-                if (node.state->channel_splitter_state) destroyChannelSplitterNode(node.state->channel_splitter_state);
-                if (node.state->channel_merger_state) destroyChannelMergerNode(node.state->channel_merger_state);
-                delete node.state;
+        // Free all node kernels, pooled kernels and automation timelines
+        for (NodeTable& table : graph->tables) {
+            for (void* kernel : table.kernels) {
+                destroyKernel(table.kind, kernel);
+            }
+            for (void* kernel : graph->kernel_pool[table.kind]) {
+                destroyKernel(table.kind, kernel);
+            }
+            for (ParamSlot& param : table.params) {
+                if (param.automation) destroyAudioParam(param.automation);
             }
         }
 
-        // Free all registered buffers
-        for (auto& pair : graph->buffers) {
-            if (pair.second.data) {
-                free(pair.second.data);
-            }
+        // Drop every reference to the sample store, which frees it
+        for (auto& pair : graph->node_samples) {
+            releaseSample(pair.second);
+        }
+        for (auto& pair : graph->samples) {
+            releaseSample(pair.second);
+        }
+        for (auto& pair : graph->periodic_waves) {
+            destroyPeriodicWaveTables(pair.second.tables);
         }
 
+        free(graph->arena);
         delete graph;
         graphs.erase(it);
     }
 }
 
+// kind is a NodeKind. Returns the new node's handle, or 0 for an unknown kind.
 EMSCRIPTEN_KEEPALIVE
-int createNode(int graph_id, const char* type_str) {
+int createNode(int graph_id, int kind) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return 0;
 
     AudioGraph* graph = it->second;
-    std::string type(type_str);
-
-    if (type == "destination") {
-        return graph->dest_id;
-    }
-
-    Node node;
-
-    // Helper to init node state
-    auto init_state = [&]() {
-        NodeState* state = new NodeState();
-        state->frequency = 440.0f;
-        state->detune = 0.0f;
-        state->gain = 1.0f;
-        state->filter_frequency = 350.0f;
-        state->filter_q = 1.0f;
-        state->filter_gain = 0.0f;
-        state->delay_time = 0.0f;
-        state->pan = 0.0f;
-        state->offset = 1.0f;
-        state->osc_state = nullptr;
-        state->gain_state = nullptr;
-        state->buffer_source_state = nullptr;
-        state->biquad_state = nullptr;
-        state->delay_state = nullptr;
-        state->waveshaper_state = nullptr;
-        state->stereo_panner_state = nullptr;
-        state->constant_source_state = nullptr;
-        state->convolver_state = nullptr;
-        state->compressor_state = nullptr;
-        state->analyser_state = nullptr;
-        state->panner_state = nullptr;
-        state->iir_filter_state = nullptr;
-        state->channel_splitter_state = nullptr;
-        state->channel_merger_state = nullptr;
-        state->media_stream_source_state = nullptr;
-        state->panner_pos_x = 0.0f;
-        state->panner_pos_y = 0.0f;
-        state->panner_pos_z = 0.0f;
-        state->panner_orient_x = 1.0f;   // spec default: facing +X
-        state->panner_orient_y = 0.0f;
-        state->panner_orient_z = 0.0f;
-        state->panner_cone_inner = 360.0f;   // spec defaults: cone disabled
-        state->panner_cone_outer = 360.0f;
-        return state;
-    };
+    if (kind < 0 || kind >= NODE_KIND_COUNT) return 0; // Unsupported
+    if (kind == NODE_DESTINATION) return graph->dest_id;
 
-    if (type == "oscillator") {
-        node.type = 1;
-        NodeState* state = init_state();
-        // Web Audio spec default is sine (0); the OscillatorNode setter pushes the
-        // requested type anyway, but make the unset default correct too.
-        state->osc_state = createOscillatorNode(graph->sample_rate, graph->channels, 0);
-        node.state = state;
-    } else if (type == "gain") {
-        node.type = 2;
-        NodeState* state = init_state();
-        state->gain_state = createGainNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "bufferSource" || type == "buffer_source") {
-        node.type = 3;
-        NodeState* state = init_state();
-        state->buffer_source_state = createBufferSourceNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "biquadFilter" || type == "biquad_filter") {
-        node.type = 4;
-        NodeState* state = init_state();
-        state->biquad_state = createBiquadFilterNode(graph->sample_rate, graph->channels, 0); // 0 = LOWPASS
-        node.state = state;
-    } else if (type == "delay") {
-        node.type = 5;
-        NodeState* state = init_state();
-        state->delay_state = createDelayNode(graph->sample_rate, graph->channels, 1.0f);
-        node.state = state;
-    } else if (type == "waveShaper" || type == "wave_shaper") {
-        node.type = 6;
-        NodeState* state = init_state();
-        state->waveshaper_state = createWaveShaperNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "stereoPanner" || type == "stereo_panner") {
-        node.type = 7;
-        NodeState* state = init_state();
-        state->stereo_panner_state = createStereoPannerNode(graph->sample_rate);
-        node.state = state;
-    } else if (type == "constantSource" || type == "constant_source") {
-        node.type = 8;
-        NodeState* state = init_state();
-        state->constant_source_state = createConstantSourceNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "convolver") {
-        node.type = 9;
-        NodeState* state = init_state();
-        state->convolver_state = createConvolverNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "dynamicsCompressor" || type == "dynamics_compressor") {
-        node.type = 10;
-        NodeState* state = init_state();
-        state->compressor_state = createDynamicsCompressorNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "analyser") {
-        node.type = 11;
-        NodeState* state = init_state();
-        state->analyser_state = createAnalyserNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "panner") {
-        node.type = 12;
-        NodeState* state = init_state();
-        state->panner_state = createPannerNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "IIRFilter" || type == "iirFilter" || type == "iir_filter") {
-        node.type = 13;
-        // IIR filter requires coefficients - will be set later via setNodeProperty
-        // Default: simple pass-through (b=[1], a=[1])
-        NodeState* state = init_state();
-        float b[] = {1.0f};
-        float a[] = {1.0f};
-        state->iir_filter_state = createIIRFilterNode(graph->sample_rate, graph->channels, b, 1, a, 1);
-        node.state = state;
-    } else if (type == "channelSplitter" || type == "channel_splitter") {
-        node.type = 14;
-        NodeState* state = init_state();
-        state->channel_splitter_state = createChannelSplitterNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "channelMerger" || type == "channel_merger") {
-        node.type = 15;
-        NodeState* state = init_state();
-        state->channel_merger_state = createChannelMergerNode(graph->sample_rate, graph->channels);
-        node.state = state;
-    } else if (type == "mediaStreamSource" || type == "media-stream-source" || type == "media_stream_source") {
-        node.type = 16;
-        NodeState* state = init_state();
-        // Don't create MediaStreamSourceNodeState here - it will be set via setMediaStreamSourceState()
-        state->media_stream_source_state = nullptr;
-        node.state = state;
-    } else {
-        return 0; // Unsupported
-    }
+    const double heap_before = graph->profiling ? sampleHeap(graph) : 0.0;
+    void* kernel = createKernel(graph, kind);
+    const double kernel_bytes = graph->profiling ? sampleHeap(graph) - heap_before : 0.0;
 
-    int node_id = graph->next_id++;
-    graph->nodes[node_id] = node;
-    return node_id;
+    int handle = tableInsert(graph->tables[kind], kernel);
+    if (!handle) {
+        destroyKernel(kind, kernel);
+        return 0;
+    }
+    if (graph->profiling) {
+        NodeProfile& profile = graph->node_profiles[handle];
+        profile.kind = kind;
+        if (kernel_bytes > 0.0) profile.bytes += kernel_bytes;
+    }
+    graph->schedule_dirty = true;
+    return handle;
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -538,27 +1142,71 @@ void connectNodes(int graph_id, int source_id, int dest_id, int output_idx, int
     if (it == graphs.end()) return;
 
     AudioGraph* graph = it->second;
-    graph->connections[dest_id].push_back(source_id);
+    int source_dense, dest_dense;
+    NodeTable* source = findNode(graph, source_id, source_dense);
+    NodeTable* dest = findNode(graph, dest_id, dest_dense);
+    if (!source || !dest) return;
+    dest->inputs[dest_dense].push_back(source_id);
+    source->outputs[source_dense].push_back(dest_id);
+    graph->schedule_dirty = true;
 }
 
+// Remove a node now, whatever it is doing: its connections are dropped and its
+// state freed. The handle is dead afterwards (and fails the generation check if
+// it is ever passed in again). The destination can't be destroyed.
 EMSCRIPTEN_KEEPALIVE
-void startNode(int graph_id, int node_id, double when) {
+void destroyNode(int graph_id, int node_id) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
 
     AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
+    int dense;
+    NodeTable* table = findNode(graph, node_id, dense);
+    if (!table || node_id == graph->dest_id) return;
+    removeNode(graph, *table, dense);
+}
+
+// JS has dropped its last reference to a node (its wrapper was garbage
+// collected). Nothing can start, stop, connect or retune it any more, so the
+// graph frees it by itself once it falls silent for good — see
+// reclaimReleasedNodes.
+EMSCRIPTEN_KEEPALIVE
+void releaseNode(int graph_id, int node_id) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return;
 
-    Node& node = node_it->second;
-    if (node.type == 1 && node.state && node.state->osc_state) { // oscillator
-        startOscillator(node.state->osc_state, when);
-    } else if (node.type == 3 && node.state && node.state->buffer_source_state) { // buffer_source
-        startBufferSource(node.state->buffer_source_state, when);
-    } else if (node.type == 8 && node.state && node.state->constant_source_state) { // constant_source
-        startConstantSource(node.state->constant_source_state);
-    } else if (node.type == 16 && node.state && node.state->media_stream_source_state) { // media_stream_source
-        startMediaStreamSource(node.state->media_stream_source_state);
+    AudioGraph* graph = it->second;
+    int dense;
+    if (!findNode(graph, node_id, dense) || node_id == graph->dest_id) return;
+    graph->released_nodes.push_back(node_id);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void startNode(int graph_id, int node_id, double when) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return;
+
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (!table || !table->kernels[dense]) return;
+    if (it->second->tracing) traceEvent(it->second, TRACE_START, node_id, -1, emscripten_get_now(), 0.0, when, 0.0);
+
+    void* kernel = table->kernels[dense];
+    switch (table->kind) {
+        case NODE_OSCILLATOR:
+            startOscillator(static_cast<OscillatorNodeState*>(kernel), when);
+            break;
+        case NODE_BUFFER_SOURCE:
+            startBufferSource(static_cast<BufferSourceNodeState*>(kernel), when);
+            break;
+        case NODE_CONSTANT_SOURCE:
+            startConstantSource(static_cast<ConstantSourceNodeState*>(kernel));
+            break;
+        case NODE_MEDIA_STREAM_SOURCE:
+            startMediaStreamSource(static_cast<MediaStreamSourceNodeState*>(kernel));
+            break;
+        default:
+            break;
     }
 }
 
@@ -567,49 +1215,28 @@ void stopNode(int graph_id, int node_id, double when) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
 
-    AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
-
-    Node& node = node_it->second;
-    if (node.type == 1 && node.state && node.state->osc_state) { // oscillator
-        stopOscillator(node.state->osc_state, when);
-    } else if (node.type == 3 && node.state && node.state->buffer_source_state) { // buffer_source
-        stopBufferSource(node.state->buffer_source_state, when);
-    } else if (node.type == 8 && node.state && node.state->constant_source_state) { // constant_source
-        stopConstantSource(node.state->constant_source_state);
-    } else if (node.type == 16 && node.state && node.state->media_stream_source_state) { // media_stream_source
-        stopMediaStreamSource(node.state->media_stream_source_state);
-    }
-}
-
-// The node's current plain value for a param (used as the automation default and
-// as the fallback when no automation is scheduled).
-static float node_param_default(NodeState* st, int param_id) {
-    switch (param_id) {
-        case PARAM_FREQUENCY: return st->frequency;
-        case PARAM_DETUNE:    return st->detune;
-        case PARAM_GAIN:      return st->gain;
-        case PARAM_Q:         return st->filter_q;
-        case PARAM_DELAY_TIME:return st->delay_time;
-        case PARAM_PAN:       return st->pan;
-        case PARAM_OFFSET:    return st->offset;
-        default:              return 0.0f;
-    }
-}
-
-// Value of an automatable param at the graph's current time (or the plain float
-// fallback if no automation has been scheduled for it).
-static float param_value_now(AudioGraph* graph, NodeState* st, int param_id, float fallback) {
-    if (!st) return fallback;
-    auto a = st->param_auto.find(param_id);
-    if (a == st->param_auto.end() || !a->second) return fallback;
-    double t;
-    if (graph->is_realtime && graph->realtime_time_initialized)
-        t = (double)(graph->current_sample - graph->realtime_start_sample) / (double)graph->sample_rate;
-    else
-        t = (double)graph->current_sample / (double)graph->sample_rate;
-    return getParamValueAtTime(a->second, t, graph->sample_rate);
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (!table || !table->kernels[dense]) return;
+    if (it->second->tracing) traceEvent(it->second, TRACE_STOP, node_id, -1, emscripten_get_now(), 0.0, when, 0.0);
+
+    void* kernel = table->kernels[dense];
+    switch (table->kind) {
+        case NODE_OSCILLATOR:
+            stopOscillator(static_cast<OscillatorNodeState*>(kernel), when);
+            break;
+        case NODE_BUFFER_SOURCE:
+            stopBufferSource(static_cast<BufferSourceNodeState*>(kernel), when);
+            break;
+        case NODE_CONSTANT_SOURCE:
+            stopConstantSource(static_cast<ConstantSourceNodeState*>(kernel));
+            break;
+        case NODE_MEDIA_STREAM_SOURCE:
+            stopMediaStreamSource(static_cast<MediaStreamSourceNodeState*>(kernel));
+            break;
+        default:
+            break;
+    }
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -617,462 +1244,1028 @@ void setNodeParameter(int graph_id, int node_id, int param_id, float value) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
 
-    AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
-
-    Node& node = node_it->second;
-    if (!node.state) return;
-
-    if (node.type == 1) { // oscillator
-        if (param_id == PARAM_FREQUENCY) node.state->frequency = value;
-        else if (param_id == PARAM_DETUNE) node.state->detune = value;
-    } else if (node.type == 2) { // gain
-        if (param_id == PARAM_GAIN) node.state->gain = value;
-    } else if (node.type == 4 && node.state->biquad_state) { // biquad_filter
-        if (param_id == PARAM_FREQUENCY) {
-            node.state->filter_frequency = value;
-            setBiquadFilterFrequency(node.state->biquad_state, value);
-        } else if (param_id == PARAM_Q) {
-            node.state->filter_q = value;
-            setBiquadFilterQ(node.state->biquad_state, value);
-        } else if (param_id == PARAM_GAIN) {
-            node.state->filter_gain = value;
-            setBiquadFilterGain(node.state->biquad_state, value);
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (!table) return;
+
+    ParamSlot* params = nodeParams(*table, dense);
+    int slot = paramSlot(table->kind, param_id);
+    if (slot >= 0) {
+        AudioGraph* graph = it->second;
+        if (graph->tracing) {
+            traceEvent(graph, TRACE_PARAM, node_id, param_id, emscripten_get_now(), 0.0, graphTime(graph), value);
         }
-    } else if (node.type == 5 && node.state->delay_state) { // delay
-        if (param_id == PARAM_DELAY_TIME) {
-            node.state->delay_time = value;
-            setDelayTime(node.state->delay_state, value);
+        params[slot].value = value;
+        // Keep the param's automation base value in sync (AudioParam.value
+        // semantics): the timeline's current_value is the value before any events.
+        if (params[slot].automation) setParamValue(params[slot].automation, value);
+    }
+
+    void* kernel = table->kernels[dense];
+    if (!kernel) return;
+
+    switch (table->kind) {
+        case NODE_BIQUAD_FILTER: {
+            BiquadFilterNodeState* biquad = static_cast<BiquadFilterNodeState*>(kernel);
+            if (param_id == PARAM_FREQUENCY) setBiquadFilterFrequency(biquad, value);
+            else if (param_id == PARAM_Q) setBiquadFilterQ(biquad, value);
+            else if (param_id == PARAM_GAIN) setBiquadFilterGain(biquad, value);
+            else if (param_id == PARAM_DETUNE) setBiquadFilterDetune(biquad, value);
+            break;
         }
-    } else if (node.type == 7 && node.state->stereo_panner_state) { // stereo_panner
-        if (param_id == PARAM_PAN) {
-            node.state->pan = value;
-            setStereoPannerPan(node.state->stereo_panner_state, value);
+        case NODE_DELAY:
+            if (param_id == PARAM_DELAY_TIME) setDelayTime(static_cast<DelayNodeState*>(kernel), value);
+            break;
+        case NODE_STEREO_PANNER:
+            if (param_id == PARAM_PAN) setStereoPannerPan(static_cast<StereoPannerNodeState*>(kernel), value);
+            break;
+        case NODE_CONSTANT_SOURCE:
+            if (param_id == PARAM_OFFSET) setConstantSourceOffset(static_cast<ConstantSourceNodeState*>(kernel), value);
+            break;
+        case NODE_PANNER: {
+            // Every one of these has a working setter on the node; nothing dispatched
+            // to them, so a game moving a 3D sound heard no change at all.
+            PannerNodeState* panner = static_cast<PannerNodeState*>(kernel);
+            switch (param_id) {
+                case PARAM_POSITION_X:
+                case PARAM_POSITION_Y:
+                case PARAM_POSITION_Z:
+                    setPannerPosition(panner, params[0].value, params[1].value, params[2].value);
+                    break;
+                case PARAM_ORIENTATION_X:
+                case PARAM_ORIENTATION_Y:
+                case PARAM_ORIENTATION_Z:
+                    setPannerOrientation(panner, params[3].value, params[4].value, params[5].value);
+                    break;
+                case PARAM_REF_DISTANCE:
+                    setPannerRefDistance(panner, value);
+                    break;
+                case PARAM_MAX_DISTANCE:
+                    setPannerMaxDistance(panner, value);
+                    break;
+                case PARAM_ROLLOFF_FACTOR:
+                    setPannerRolloffFactor(panner, value);
+                    break;
+                case PARAM_CONE_INNER_ANGLE:
+                case PARAM_CONE_OUTER_ANGLE:
+                    setPannerConeAngles(panner, params[6].value, params[7].value);
+                    break;
+                case PARAM_CONE_OUTER_GAIN:
+                    setPannerConeOuterGain(panner, value);
+                    break;
+                default:
+                    break;
+            }
+            break;
         }
-    } else if (node.type == 8 && node.state->constant_source_state) { // constant_source
-        if (param_id == PARAM_OFFSET) {
-            node.state->offset = value;
-            setConstantSourceOffset(node.state->constant_source_state, value);
+        case NODE_DYNAMICS_COMPRESSOR: {
+            DynamicsCompressorNodeState* compressor = static_cast<DynamicsCompressorNodeState*>(kernel);
+            switch (param_id) {
+                case PARAM_THRESHOLD: setCompressorThreshold(compressor, value); break;
+                case PARAM_KNEE:      setCompressorKnee(compressor, value); break;
+                case PARAM_RATIO:     setCompressorRatio(compressor, value); break;
+                case PARAM_ATTACK:    setCompressorAttack(compressor, value); break;
+                case PARAM_RELEASE:   setCompressorRelease(compressor, value); break;
+                default: break;
+            }
+            break;
         }
-    } else if (node.type == 12 && node.state->panner_state) { // panner
-        // Every one of these has a working setter on the node; nothing dispatched
-        // to them, so a game moving a 3D sound heard no change at all.
-        switch (param_id) {
-            case PARAM_POSITION_X:
-            case PARAM_POSITION_Y:
-            case PARAM_POSITION_Z:
-                if (param_id == PARAM_POSITION_X) node.state->panner_pos_x = value;
-                else if (param_id == PARAM_POSITION_Y) node.state->panner_pos_y = value;
-                else node.state->panner_pos_z = value;
-                setPannerPosition(node.state->panner_state,
-                                  node.state->panner_pos_x,
-                                  node.state->panner_pos_y,
-                                  node.state->panner_pos_z);
-                break;
-            case PARAM_ORIENTATION_X:
-            case PARAM_ORIENTATION_Y:
-            case PARAM_ORIENTATION_Z:
-                if (param_id == PARAM_ORIENTATION_X) node.state->panner_orient_x = value;
-                else if (param_id == PARAM_ORIENTATION_Y) node.state->panner_orient_y = value;
-                else node.state->panner_orient_z = value;
-                setPannerOrientation(node.state->panner_state,
-                                     node.state->panner_orient_x,
-                                     node.state->panner_orient_y,
-                                     node.state->panner_orient_z);
-                break;
-            case PARAM_REF_DISTANCE:
-                setPannerRefDistance(node.state->panner_state, value);
-                break;
-            case PARAM_MAX_DISTANCE:
-                setPannerMaxDistance(node.state->panner_state, value);
-                break;
-            case PARAM_ROLLOFF_FACTOR:
-                setPannerRolloffFactor(node.state->panner_state, value);
-                break;
-            case PARAM_CONE_INNER_ANGLE:
-            case PARAM_CONE_OUTER_ANGLE:
-                if (param_id == PARAM_CONE_INNER_ANGLE) node.state->panner_cone_inner = value;
-                else node.state->panner_cone_outer = value;
-                setPannerConeAngles(node.state->panner_state,
-                                    node.state->panner_cone_inner,
-                                    node.state->panner_cone_outer);
-                break;
-            case PARAM_CONE_OUTER_GAIN:
-                setPannerConeOuterGain(node.state->panner_state, value);
-                break;
-            default:
-                break;
+        case NODE_BUFFER_SOURCE: {
+            // The JS side maps AudioBufferSourceNode.loop to PARAM_LOOP
+            // (WasmAudioEngine.js PARAM_ID_MAP), but nothing consumed it here,
+            // so a looping source played once and stopped.
+            BufferSourceNodeState* source = static_cast<BufferSourceNodeState*>(kernel);
+            switch (param_id) {
+                case PARAM_LOOP:            setBufferSourceLoop(source, value != 0.0f); break;
+                case PARAM_LOOP_START:      setBufferSourceLoopStart(source, value); break;
+                case PARAM_LOOP_END:        setBufferSourceLoopEnd(source, value); break;
+                case PARAM_PLAYBACK_OFFSET: setBufferSourceOffset(source, value); break;
+                default: break;
+            }
+            break;
         }
-    } else if (node.type == 10 && node.state->compressor_state) { // dynamics_compressor
-        switch (param_id) {
-            case PARAM_THRESHOLD: setCompressorThreshold(node.state->compressor_state, value); break;
-            case PARAM_KNEE:      setCompressorKnee(node.state->compressor_state, value); break;
-            case PARAM_RATIO:     setCompressorRatio(node.state->compressor_state, value); break;
-            case PARAM_ATTACK:    setCompressorAttack(node.state->compressor_state, value); break;
-            case PARAM_RELEASE:   setCompressorRelease(node.state->compressor_state, value); break;
-            default: break;
+        default:
+            break;
+    }
+}
+
+// Kernels that can't run with output == input. Stereo panner and panner expand
+// a mono input to two output channels; the splitter reads interleaved and writes
+// planar. Everything else finishes reading a frame before writing it.
+static bool kernelIsInPlaceSafe(int type) {
+    return type != NODE_STEREO_PANNER && type != NODE_PANNER && type != NODE_CHANNEL_SPLITTER;
+}
+
+// Give every scheduled step an output slot in the arena, like a register
+// allocator over the linear schedule: a step's slot goes back on the free list
+// once its last reader has run. A reader that is in-place safe and the last user
+// of one of its inputs takes that input's slot over as its own output, so
+// chains of filters/gains keep rewriting the same buffer. The destination gets
+// no slot; it mixes into processGraph's output.
+static void assignRenderBuffers(AudioGraph* graph) {
+    const int n = static_cast<int>(graph->schedule.size());
+    const int dest_step = n - 1;
+
+    std::vector<int> last_use(n, -1);
+    for (int i = 0; i < n; ++i) {
+        for (int src : graph->schedule[i].inputs) last_use[src] = i;
+        for (const ParamBus& bus : graph->schedule[i].param_buses) {
+            for (int src : bus.steps) last_use[src] = i;
+        }
+    }
+
+    std::vector<int> slot_of(n, -1);
+    std::vector<int> coalesced(n, -1);  // index into inputs whose slot was taken over
+    std::vector<bool> released(n, false);
+    std::vector<int> free_slots;
+    int slot_count = 2;  // slot 0 is mix scratch, slot 1 silence
+
+    for (int i = 0; i < dest_step; ++i) {
+        const ScheduledNode& step = graph->schedule[i];
+
+        if (kernelIsInPlaceSafe(step.type)) {
+            for (size_t k = 0; k < step.inputs.size(); ++k) {
+                int src = step.inputs[k];
+                // An input connected twice would be read back from the slot
+                // after the mix had already added into it.
+                if (last_use[src] == i && !released[src] &&
+                    std::count(step.inputs.begin(), step.inputs.end(), src) == 1) {
+                    slot_of[i] = slot_of[src];
+                    coalesced[i] = static_cast<int>(k);
+                    released[src] = true;
+                    break;
+                }
+            }
+        }
+        if (slot_of[i] < 0) {
+            if (!free_slots.empty()) {
+                slot_of[i] = free_slots.back();
+                free_slots.pop_back();
+            } else {
+                slot_of[i] = slot_count++;
+            }
         }
-    } else if (node.type == 3 && node.state->buffer_source_state) { // buffer_source
-        // The JS side maps AudioBufferSourceNode.loop to PARAM_LOOP
-        // (WasmAudioEngine.js PARAM_ID_MAP), but nothing consumed it here,
-        // so a looping source played once and stopped.
-        if (param_id == PARAM_LOOP) {
-            setBufferSourceLoop(node.state->buffer_source_state, value != 0.0f);
+
+        // Inputs read for the last time here are free from the next step on.
+        for (int src : step.inputs) {
+            if (last_use[src] == i && !released[src]) {
+                released[src] = true;
+                free_slots.push_back(slot_of[src]);
+            }
+        }
+        for (const ParamBus& bus : step.param_buses) {
+            for (int src : bus.steps) {
+                if (last_use[src] == i && !released[src]) {
+                    released[src] = true;
+                    free_slots.push_back(slot_of[src]);
+                }
+            }
         }
     }
-    // Keep the param's automation base value in sync (AudioParam.value semantics):
-    // if a timeline exists, its current_value is the value before any events.
-    auto a = node.state->param_auto.find(param_id);
-    if (a != node.state->param_auto.end() && a->second) setParamValue(a->second, value);
-}
 
-// Process a single node
-void processNode(AudioGraph* graph, int node_id, float* output, int frame_count) {
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) {
-        memset(output, 0, frame_count * graph->channels * sizeof(float));
-        return;
+    if (slot_count > graph->arena_slots) {
+        free(graph->arena);
+        graph->arena = static_cast<float*>(
+            aligned_alloc(16, static_cast<size_t>(slot_count) * graph->slot_floats * sizeof(float)));
+        graph->arena_slots = slot_count;
+        graph->silence = graph->arena + graph->slot_floats;
+        memset(graph->silence, 0, graph->slot_floats * sizeof(float));
     }
+    float* scratch = graph->arena;
+    for (int i = 0; i < n; ++i) {
+        ScheduledNode& step = graph->schedule[i];
+        step.output = (i == dest_step) ? nullptr : graph->arena + slot_of[i] * graph->slot_floats;
+        step.mix_sources.clear();
+        step.mix_steps.clear();
+        step.accumulated_step = coalesced[i] >= 0 ? step.inputs[coalesced[i]] : -1;
+        for (ParamBus& bus : step.param_buses) {
+            bus.sources.clear();
+            for (int src : bus.steps) bus.sources.push_back(graph->arena + slot_of[src] * graph->slot_floats);
+        }
 
-    Node& node = node_it->second;
+        if (step.inputs.empty()) {
+            step.input = step.output;
+        } else if (step.inputs.size() == 1) {
+            step.input = graph->arena + slot_of[step.inputs[0]] * graph->slot_floats;
+        } else {
+            // Fan-in: sum into the output slot when the kernel can run in place
+            // (starting from the input whose slot it took over, if any),
+            // otherwise into scratch. The destination's target is set per quantum.
+            step.input = kernelIsInPlaceSafe(step.type) ? step.output : scratch;
+            for (size_t k = 0; k < step.inputs.size(); ++k) {
+                if (static_cast<int>(k) == coalesced[i]) continue;
+                step.mix_sources.push_back(graph->arena + slot_of[step.inputs[k]] * graph->slot_floats);
+                step.mix_steps.push_back(step.inputs[k]);
+            }
+        }
+    }
 
-    // Check if already processed this frame
-    auto cached_it = graph->node_buffers.find(node_id);
-    if (cached_it != graph->node_buffers.end()) {
-        memcpy(output, cached_it->second.data(), frame_count * graph->channels * sizeof(float));
-        return;
+    // The destination always sums into the caller's buffer, even a single input.
+    ScheduledNode& dest = graph->schedule[dest_step];
+    dest.mix_sources.clear();
+    dest.mix_steps.clear();
+    for (int src : dest.inputs) {
+        dest.mix_sources.push_back(graph->arena + slot_of[src] * graph->slot_floats);
+        dest.mix_steps.push_back(src);
     }
+}
 
-    // Process based on node type
-    if (node.type == 0) { // destination
-        // Mix all inputs
-        memset(output, 0, frame_count * graph->channels * sizeof(float));
+// Compile the render schedule: depth-first from the destination over the
+// nodes' input lists, emitting every node after all of the nodes it pulls from
+// (post-order). One forward walk over the result then renders each node exactly
+// once, with its inputs already sitting in their render buffers. Nodes that can't
+// reach the destination are not scheduled — the old pull renderer never visited
+// them either.
+//
+// Nodes connected into a param are pulled in the same way, so a modulator (an
+// LFO feeding a frequency, say) renders before the node whose param it drives,
+// whether or not it is also connected to anything audible.
+//
+// An edge back to a node that is still on the DFS stack closes a cycle. The
+// recursive renderer followed those until the stack overflowed; here the edge is
+// dropped so the rest of the graph keeps rendering.
+static void compileSchedule(AudioGraph* graph) {
+    graph->schedule.clear();
+
+    int dest_dense;
+    if (!findNode(graph, graph->dest_id, dest_dense)) return;
+
+    // Per kind, by dense position: schedule index once emitted, UNVISITED, or
+    // ON_STACK while the node's inputs are being walked.
+    const int UNVISITED = -1;
+    const int ON_STACK = -2;
+    std::vector<int> step_of[NODE_KIND_COUNT];
+    for (int kind = 0; kind < NODE_KIND_COUNT; ++kind) {
+        step_of[kind].assign(graph->tables[kind].handles.size(), UNVISITED);
+    }
 
-        auto conn_it = graph->connections.find(node_id);
-        if (conn_it != graph->connections.end()) {
-            // Use pre-allocated temp_buffer instead of allocating new vector
-            const int buffer_size = frame_count * graph->channels;
+    struct Visit {
+        int kind;
+        int dense;
+        size_t next_input;
+    };
+    std::vector<Visit> stack;
+    stack.push_back({NODE_DESTINATION, dest_dense, 0});
+    step_of[NODE_DESTINATION][dest_dense] = ON_STACK;
+
+    while (!stack.empty()) {
+        Visit& top = stack.back();
+        NodeTable& table = graph->tables[top.kind];
+        const std::vector<int>& inputs = table.inputs[top.dense];
+        const std::vector<ParamInput>& param_inputs = table.param_inputs[top.dense];
+
+        // Audio inputs first, then param inputs
+        if (top.next_input < inputs.size() + param_inputs.size()) {
+            const size_t k = top.next_input++;
+            const int source_id = k < inputs.size() ? inputs[k] : param_inputs[k - inputs.size()].source;
+            int source_dense;
+            NodeTable* source = findNode(graph, source_id, source_dense);
+            if (!source || step_of[source->kind][source_dense] != UNVISITED) continue;
+            step_of[source->kind][source_dense] = ON_STACK;
+            stack.push_back({source->kind, source_dense, 0});
+            continue;
+        }
 
-            for (int source_id : conn_it->second) {
-                processNode(graph, source_id, graph->temp_buffer.data(), frame_count);
+        // Every input has been emitted (or dropped as a cycle edge): emit this node.
+        ScheduledNode step;
+        step.node_id = table.handles[top.dense];
+        step.type = top.kind;
+        step.dense = top.dense;
+        for (int source_id : inputs) {
+            int source_dense;
+            NodeTable* source = findNode(graph, source_id, source_dense);
+            if (source && step_of[source->kind][source_dense] >= 0) {
+                step.inputs.push_back(step_of[source->kind][source_dense]);
+            }
+        }
+        for (const ParamInput& in : param_inputs) {
+            int source_dense;
+            NodeTable* source = findNode(graph, in.source, source_dense);
+            if (!source || step_of[source->kind][source_dense] < 0) continue;
+            auto bus = std::find_if(step.param_buses.begin(), step.param_buses.end(),
+                                    [&in](const ParamBus& b) { return b.slot == in.slot; });
+            if (bus == step.param_buses.end()) {
+                step.param_buses.push_back({in.slot, {}, {}});
+                bus = step.param_buses.end() - 1;
+            }
+            bus->steps.push_back(step_of[source->kind][source_dense]);
+        }
+        step_of[top.kind][top.dense] = static_cast<int>(graph->schedule.size());
+        graph->schedule.push_back(std::move(step));
+        stack.pop_back();
+    }
+
+    graph->step_silent.assign(graph->schedule.size(), 0);
+    assignRenderBuffers(graph);
+}
 
-                // Mix with SIMD optimization
-                int i = 0;
+// Sum the audible ones of `sources` (written by `steps`) into `target`. Unless
+// `accumulate` is set (target already holds one input), the first of them is
+// copied rather than added. Returns false when nothing was written: no
+// accumulated input and every source silent.
+//
+// Every input is summed, as the spec requires. The recursive renderer only did
+// that for gain and the destination; filters, delays etc. read inputs[0] only
+// and silently dropped anything else connected to them.
+static bool mixSources(AudioGraph* graph, float* target, const std::vector<float*>& sources,
+                       const std::vector<int>& steps, bool accumulate, int sample_count) {
+    bool filled = accumulate;
+    for (size_t k = 0; k < sources.size(); ++k) {
+        if (graph->step_silent[steps[k]]) continue;
+        const float* input = sources[k];
+        if (!filled) {
+            memcpy(target, input, sample_count * sizeof(float));
+            filled = true;
+            continue;
+        }
+
+        int i = 0;
 #ifdef __wasm_simd128__
-                // Process 4 samples at a time with SIMD
-                for (; i + 4 <= buffer_size; i += 4) {
-                    v128_t out = wasm_v128_load(&output[i]);
-                    v128_t in = wasm_v128_load(&graph->temp_buffer[i]);
-                    v128_t mixed = wasm_f32x4_add(out, in);
-                    wasm_v128_store(&output[i], mixed);
-                }
+        // Mix 4 samples at a time with SIMD
+        for (; i + 4 <= sample_count; i += 4) {
+            v128_t out = wasm_v128_load(&target[i]);
+            v128_t in = wasm_v128_load(&input[i]);
+            wasm_v128_store(&target[i], wasm_f32x4_add(out, in));
+        }
 #endif
-                // Scalar tail for remaining samples
-                for (; i < buffer_size; ++i) {
-                    output[i] += graph->temp_buffer[i];
+        // Scalar tail for remaining samples
+        for (; i < sample_count; ++i) {
+            target[i] += input[i];
+        }
+    }
+    return filled;
+}
+
+// Prepare this quantum's input for a step and return it, or nullptr when every
+// input is silent (or nothing is connected). A single input is read straight
+// from the upstream slot; only fan-in costs a pass over the samples, and silent
+// inputs are left out of the sum.
+static float* gatherInputs(AudioGraph* graph, const ScheduledNode& step, int sample_count) {
+    if (step.inputs.empty()) return nullptr;
+    if (step.inputs.size() == 1) {
+        return graph->step_silent[step.inputs[0]] ? nullptr : step.input;
+    }
+    // The slot this step took over holds stale samples if its writer was silent.
+    bool accumulate = step.accumulated_step >= 0 && !graph->step_silent[step.accumulated_step];
+    return mixSources(graph, step.input, step.mix_sources, step.mix_steps, accumulate, sample_count)
+        ? step.input : nullptr;
+}
+
+// Frames a processor goes on producing sound once its input falls silent, or
+// -1 if it can't be skipped at all. Stateless nodes output silence for silent
+// input straight away.
+static int tailFrames(int type, void* kernel) {
+    switch (type) {
+        case NODE_BIQUAD_FILTER:
+            return getBiquadFilterTailFrames(static_cast<BiquadFilterNodeState*>(kernel));
+        case NODE_DELAY:
+            return getDelayTailFrames(static_cast<DelayNodeState*>(kernel));
+        case NODE_CONVOLVER:
+            return getConvolverTailFrames(static_cast<ConvolverNodeState*>(kernel));
+        case NODE_DYNAMICS_COMPRESSOR:
+            return getDynamicsCompressorTailFrames(static_cast<DynamicsCompressorNodeState*>(kernel));
+        case NODE_ANALYSER:
+            return getAnalyserTailFrames(static_cast<AnalyserNodeState*>(kernel));
+        case NODE_IIR_FILTER:
+            return getIIRFilterTailFrames(static_cast<IIRFilterNodeState*>(kernel));
+        case NODE_WAVE_SHAPER:
+            return -1;  // a curve can map silence to a constant offset
+        default:
+            return 0;   // gain, panners, splitter, merger
+    }
+}
+
+// Whether a node kind is a source: it makes its own sound and has no inputs.
+static bool isSourceKind(int type) {
+    return type == NODE_OSCILLATOR || type == NODE_BUFFER_SOURCE ||
+           type == NODE_CONSTANT_SOURCE || type == NODE_MEDIA_STREAM_SOURCE;
+}
+
+// A step's param values for this quantum. `values` gets each param's value at
+// the quantum's first frame. Returns whether any param changes within the
+// quantum - automation ramping or an audio-rate input connected - in which case
+// graph->param_rates holds every param frame by frame (sample-accurate
+// automation, plus for a param with a bus the output of each audible node
+// feeding it, down-mixed to mono by averaging its channels) and the step needs
+// its kernel's a-rate variant.
+static bool computeParamRates(AudioGraph* graph, const ScheduledNode& step, const ParamSlot* params,
+                              int param_count, int frame_count, float* values) {
+    bool varies[MAX_NODE_PARAMS] = {};
+    bool a_rate = !step.param_buses.empty();
+    for (int p = 0; p < param_count; ++p) {
+        if (!params[p].automation) {
+            values[p] = params[p].value;
+            continue;
+        }
+        varies[p] = renderParamValues(params[p].automation, graphTime(graph), graph->sample_rate,
+                                      graph->param_rates[p], frame_count) != 0;
+        values[p] = graph->param_rates[p][0];
+        a_rate = a_rate || varies[p];
+    }
+    if (!a_rate) return false;
+
+    for (int p = 0; p < param_count; ++p) {
+        if (!varies[p]) std::fill(graph->param_rates[p], graph->param_rates[p] + frame_count, values[p]);
+    }
+
+    const int channels = graph->channels;
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (const ParamBus& bus : step.param_buses) {
+        float* rates = graph->param_rates[bus.slot];
+        for (size_t k = 0; k < bus.sources.size(); ++k) {
+            if (graph->step_silent[bus.steps[k]]) continue;
+            const float* source = bus.sources[k];
+            if (channels == 1) {
+                for (int i = 0; i < frame_count; ++i) rates[i] += source[i];
+            } else {
+                for (int i = 0; i < frame_count; ++i) {
+                    float sum = 0.0f;
+                    for (int ch = 0; ch < channels; ++ch) sum += source[i * channels + ch];
+                    rates[i] += sum * scale;
                 }
             }
         }
+    }
+    return true;
+}
 
-    } else if (node.type == 1) { // oscillator
-        if (!node.state || !node.state->osc_state) {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
+// Run one scheduled node for one quantum into `output` (its arena slot, or the
+// caller's buffer for the destination). Its inputs have already been rendered
+// this quantum (schedule order guarantees it).
+//
+// Returns false when the node was skipped as silent, leaving `output`
+// unwritten: a source that isn't playing, or a processor whose inputs have
+// been silent for longer than its tail. Everything downstream of an idle
+// source therefore costs a flag check per quantum once its tails have run out.
+static bool processScheduledNode(AudioGraph* graph, const ScheduledNode& step, float* output,
+                                 int frame_count, double current_time) {
+    NodeTable& table = graph->tables[step.type];
+    void* kernel = table.kernels[step.dense];
+    const ParamSlot* params = nodeParams(table, step.dense);
+    const int sample_count = frame_count * graph->channels;
+
+    if (step.type == NODE_DESTINATION) {
+        if (!mixSources(graph, output, step.mix_sources, step.mix_steps, false, sample_count)) {
+            memset(output, 0, sample_count * sizeof(float));
+        }
+        return true;
+    }
+
+    if (!kernel) return false;
+
+    // Params that change within the quantum go through the kernels' a-rate
+    // variants. Computed before the inputs are mixed: mixing can write into the
+    // slot of a node that feeds both an input and a param. Oscillator, gain,
+    // buffer source, biquad, delay, stereo panner and constant source params
+    // are rendered per frame; other kinds ignore param automation.
+    float values[MAX_NODE_PARAMS];
+    const bool a_rate = computeParamRates(graph, step, params, table.param_count, frame_count, values);
+
+    // Processors run on silence only while they still have a tail to play out.
+    // Kernels are then always called with has_input = true: with has_input =
+    // false they cut straight to zeros, dropping the tail.
+    float* input = nullptr;
+    if (!isSourceKind(step.type)) {
+        input = gatherInputs(graph, step, sample_count);
+        int& silent_frames = table.silent_frames[step.dense];
+        if (input) {
+            silent_frames = 0;
         } else {
+            const int tail = tailFrames(step.type, kernel);
+            if (tail >= 0) {
+                if (silent_frames >= tail) return false;
+                silent_frames += frame_count;
+            }
+            input = graph->silence;
+        }
+    }
+
+    switch (step.type) {
+        case NODE_OSCILLATOR: {
+            OscillatorNodeState* osc = static_cast<OscillatorNodeState*>(kernel);
             // Update current time for scheduled start/stop
-            // Use relative time for real-time contexts (same logic as getGraphCurrentTime)
-            double current_time;
-            if (graph->is_realtime && graph->realtime_time_initialized) {
-                current_time = static_cast<double>(graph->current_sample - graph->realtime_start_sample)
-                             / static_cast<double>(graph->sample_rate);
-            } else {
-                current_time = static_cast<double>(graph->current_sample) / static_cast<double>(graph->sample_rate);
+            setOscillatorCurrentTime(osc, current_time);
+            if (!isOscillatorActive(osc)) return false;
+
+            if (a_rate) {
+                processOscillatorNodeARate(osc, output, frame_count, graph->param_rates[0], graph->param_rates[1]);
+                break;
             }
-            setOscillatorCurrentTime(node.state->osc_state, current_time);
 
-            // Call external SIMD-optimized oscillator. Params are evaluated at the
-            // current time so frequency/detune automation (glides) works.
+            // Call external SIMD-optimized oscillator with frequency/detune held
+            // for the whole quantum.
             processOscillatorNode(
-                node.state->osc_state,
+                osc,
                 output,
                 frame_count,
-                param_value_now(graph, node.state, PARAM_FREQUENCY, node.state->frequency),
-                param_value_now(graph, node.state, PARAM_DETUNE, node.state->detune)
+                values[0],  // frequency
+                values[1]   // detune
             );
+            break;
+        }
+
+        case NODE_GAIN:
+            if (a_rate) {
+                processGainNodeARate(static_cast<GainNodeState*>(kernel), input, output, frame_count,
+                                     graph->param_rates[0]);
+                break;
+            }
+            // Call external SIMD-optimized gain, the gain held for the whole quantum
+            processGainNode(
+                static_cast<GainNodeState*>(kernel),
+                input,
+                output,
+                frame_count,
+                values[0],
+                true
+            );
+            break;
+
+        case NODE_BUFFER_SOURCE: {
+            BufferSourceNodeState* source = static_cast<BufferSourceNodeState*>(kernel);
+            // Update current time for scheduled start/stop
+            setBufferSourceCurrentTime(source, current_time);
+            if (!isBufferSourceActive(source)) return false;
+            if (a_rate) {
+                processBufferSourceNodeARate(source, output, frame_count, graph->param_rates[0], graph->param_rates[1]);
+                break;
+            }
+            processBufferSourceNode(source, output, frame_count, values[0], values[1]);  // playbackRate, detune
+            break;
+        }
+
+        case NODE_BIQUAD_FILTER: {
+            BiquadFilterNodeState* biquad = static_cast<BiquadFilterNodeState*>(kernel);
+            if (a_rate) {
+                processBiquadFilterNodeARate(biquad, input, output, frame_count,
+                                             graph->param_rates[0], graph->param_rates[1], graph->param_rates[2],
+                                             graph->param_rates[3]);
+                break;
+            }
+            // The kernel keeps its own copy of its params; automation holding a
+            // value this quantum is pushed through the setters.
+            if (params[0].automation) setBiquadFilterFrequency(biquad, values[0]);
+            if (params[1].automation) setBiquadFilterQ(biquad, values[1]);
+            if (params[2].automation) setBiquadFilterGain(biquad, values[2]);
+            if (params[3].automation) setBiquadFilterDetune(biquad, values[3]);
+            processBiquadFilterNode(biquad, input, output, frame_count, true);
+            break;
+        }
+
+        case NODE_DELAY: {
+            DelayNodeState* delay = static_cast<DelayNodeState*>(kernel);
+            if (a_rate) {
+                processDelayNodeARate(delay, input, output, frame_count, graph->param_rates[0]);
+                break;
+            }
+            if (params[0].automation) setDelayTime(delay, values[0]);
+            processDelayNode(delay, input, output, frame_count, true);
+            break;
+        }
+
+        case NODE_WAVE_SHAPER:
+            processWaveShaperNode(static_cast<WaveShaperNodeState*>(kernel), input, output, frame_count, true);
+            break;
+
+        case NODE_STEREO_PANNER: {
+            StereoPannerNodeState* panner = static_cast<StereoPannerNodeState*>(kernel);
+            if (a_rate) {
+                processStereoPannerNodeARate(panner, input, output, frame_count, graph->channels,
+                                             graph->param_rates[0]);
+                break;
+            }
+            if (params[0].automation) setStereoPannerPan(panner, values[0]);
+            processStereoPannerNode(panner, input, output, frame_count, graph->channels, true);
+            break;
+        }
+
+        case NODE_CONSTANT_SOURCE: {
+            ConstantSourceNodeState* source = static_cast<ConstantSourceNodeState*>(kernel);
+            if (!isConstantSourcePlaying(source)) return false;
+            if (a_rate) {
+                processConstantSourceNodeARate(source, output, frame_count, graph->param_rates[0]);
+                break;
+            }
+            if (params[0].automation) setConstantSourceOffset(source, values[0]);
+            processConstantSourceNode(source, output, frame_count);
+            break;
+        }
+
+        case NODE_CONVOLVER:
+            processConvolverNode(static_cast<ConvolverNodeState*>(kernel), input, output, frame_count, true);
+            break;
+
+        case NODE_DYNAMICS_COMPRESSOR:
+            processDynamicsCompressorNode(static_cast<DynamicsCompressorNodeState*>(kernel), input, output,
+                                          frame_count, true);
+            break;
+
+        case NODE_ANALYSER:
+            processAnalyserNode(static_cast<AnalyserNodeState*>(kernel), input, output, frame_count, true);
+            break;
+
+        case NODE_PANNER:
+            processPannerNode(static_cast<PannerNodeState*>(kernel), input, output, frame_count, true);
+            break;
+
+        case NODE_IIR_FILTER:
+            processIIRFilterNode(static_cast<IIRFilterNodeState*>(kernel), input, output, frame_count, true);
+            break;
+
+        case NODE_CHANNEL_SPLITTER:
+            processChannelSplitterNode(static_cast<ChannelSplitterNodeState*>(kernel), input, output, frame_count,
+                                       graph->channels, true);
+            break;
+
+        case NODE_CHANNEL_MERGER:
+            processChannelMergerNodeSimple(static_cast<ChannelMergerNodeState*>(kernel), input, output,
+                                           frame_count, graph->channels, true);
+            break;
+
+        case NODE_MEDIA_STREAM_SOURCE:
+            // Pull audio from microphone ring buffer
+            // Pass graph->channels so it can up-mix mono to stereo if needed
+            processMediaStreamSourceNode(static_cast<MediaStreamSourceNodeState*>(kernel), output, frame_count,
+                                         graph->channels);
+            break;
+
+        default: // Unknown node type
+            return false;
+    }
+    return true;
+}
+
+// processScheduledNode, timed and with its allocations counted when the graph
+// is being profiled.
+static bool processStep(AudioGraph* graph, const ScheduledNode& step, float* output,
+                        int frame_count, double current_time) {
+    if (!graph->profiling && !graph->tracing) {
+        return processScheduledNode(graph, step, output, frame_count, current_time);
+    }
+
+    NodeProfile* profile = graph->profiling ? &graph->node_profiles[step.node_id] : nullptr;
+    const double heap_before = profile ? sampleHeap(graph) : 0.0;
+    const double start = emscripten_get_now();
+    const bool audible = processScheduledNode(graph, step, output, frame_count, current_time);
+    const double elapsed = emscripten_get_now() - start;
+
+    if (profile) {
+        const double grown = sampleHeap(graph) - heap_before;
+        if (grown > 0.0) profile->bytes += grown;
+        profile->kind = step.type;
+        profile->calls++;
+        profile->total_ms += elapsed;
+        if (elapsed > profile->max_ms) profile->max_ms = elapsed;
+        graph->quantum_node_ms += elapsed;
+    }
+    if (graph->tracing) {
+        traceEvent(graph, TRACE_NODE, step.node_id, -1, start, elapsed, current_time, audible ? 1.0 : 0.0);
+    }
+    return audible;
+}
+
+// De-interleave `frame_count` frames into planar channels that start
+// `channel_stride` floats apart: channel c of frame i goes to
+// planar[c * channel_stride + i]. With a stride of the whole render length this
+// writes one quantum straight into its place in a planar render result.
+static void deinterleaveStrided(const float* interleaved, float* planar, size_t channel_stride,
+                                int frame_count, int num_channels) {
+    if (num_channels == 1) {
+        // Mono - just copy
+        memcpy(planar, interleaved, frame_count * sizeof(float));
+        return;
+    }
+
+    if (num_channels == 2) {
+        // Stereo - optimized SIMD path
+#ifdef __wasm_simd128__
+        int simd_count = frame_count / 4; // Process 4 frames at a time
+        int simd_frames = simd_count * 4;
+
+        float* left = planar;
+        float* right = planar + channel_stride;
+
+        for (int i = 0; i < simd_frames; i += 4) {
+            // Load 8 floats: L0,R0,L1,R1,L2,R2,L3,R3
+            v128_t data0 = wasm_v128_load(&interleaved[i * 2]);
+            v128_t data1 = wasm_v128_load(&interleaved[i * 2 + 4]);
+
+            // Shuffle to separate L and R
+            // data0: L0,R0,L1,R1  data1: L2,R2,L3,R3
+            // Want:  L0,L1,L2,L3 and R0,R1,R2,R3
+            v128_t left_vec = wasm_i32x4_shuffle(data0, data1, 0, 2, 4, 6);  // L0,L1,L2,L3
+            v128_t right_vec = wasm_i32x4_shuffle(data0, data1, 1, 3, 5, 7); // R0,R1,R2,R3
+
+            wasm_v128_store(&left[i], left_vec);
+            wasm_v128_store(&right[i], right_vec);
+        }
+
+        // Handle remaining frames
+        for (int i = simd_frames; i < frame_count; i++) {
+            left[i] = interleaved[i * 2];
+            right[i] = interleaved[i * 2 + 1];
+        }
+#else
+        // Scalar fallback for stereo
+        float* left = planar;
+        float* right = planar + channel_stride;
+        for (int i = 0; i < frame_count; i++) {
+            left[i] = interleaved[i * 2];
+            right[i] = interleaved[i * 2 + 1];
+        }
+#endif
+    } else {
+        // Generic multi-channel (scalar - less common case)
+        for (int ch = 0; ch < num_channels; ch++) {
+            float* channel_out = planar + ch * channel_stride;
+            for (int i = 0; i < frame_count; i++) {
+                channel_out[i] = interleaved[i * num_channels + ch];
+            }
         }
+    }
+}
 
-    } else if (node.type == 2) { // gain
-        if (!node.state || !node.state->gain_state) {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        } else {
-            // Process and MIX all inputs
-            auto conn_it = graph->connections.find(node_id);
-            bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-
-            if (has_input) {
-                // Mix all inputs together
-                memset(output, 0, frame_count * graph->channels * sizeof(float));
-                const int buffer_size = frame_count * graph->channels;
-
-                for (int source_id : conn_it->second) {
-                    // Use mix_buffer instead of temp_buffer to avoid recursion conflicts
-                    processNode(graph, source_id, graph->mix_buffer.data(), frame_count);
+// Render `frame_count` frames. Output is interleaved, or with a nonzero
+// `planar_stride` planar: channel c of frame i at output[c * planar_stride + i].
+// Planar output is mixed into scratch by the destination and de-interleaved into
+// place one quantum at a time, while it is still in cache.
+static void renderGraph(AudioGraph* graph, float* output, int frame_count, size_t planar_stride = 0) {
+    // Initialize real-time timing offset on first render
+    // Capture the sample position when we first start processing to establish "time zero"
+    if (graph->is_realtime && !graph->realtime_time_initialized) {
+        graph->realtime_start_sample = graph->current_sample;
+        graph->realtime_time_initialized = true;
+    }
 
-                    // Mix this source into output with SIMD optimization
-                    int i = 0;
-#ifdef __wasm_simd128__
-                    // Process 4 samples at a time with SIMD
-                    for (; i + 4 <= buffer_size; i += 4) {
-                        v128_t out = wasm_v128_load(&output[i]);
-                        v128_t in = wasm_v128_load(&graph->mix_buffer[i]);
-                        v128_t mixed = wasm_f32x4_add(out, in);
-                        wasm_v128_store(&output[i], mixed);
-                    }
-#endif
-                    // Scalar tail for remaining samples
-                    for (; i < buffer_size; ++i) {
-                        output[i] += graph->mix_buffer[i];
-                    }
-                }
+    // Render the block one quantum at a time so every node's output fits in its
+    // arena slot. Real-time contexts ask for several quanta per call.
+    for (int offset = 0; offset < frame_count; offset += RENDER_QUANTUM) {
+        const int quantum_frames = frame_count - offset < RENDER_QUANTUM ? frame_count - offset : RENDER_QUANTUM;
+        const double quantum_start = (graph->profiling || graph->tracing) ? emscripten_get_now() : 0.0;
+        const double heap_sampled_before = graph->heap_sample_ms;
+        graph->quantum_node_ms = 0.0;
+        if (graph->tracing) {
+            const double heap_bytes = static_cast<double>(emscripten_get_heap_size());
+            if (heap_bytes != graph->trace_heap_bytes) {
+                traceEvent(graph, TRACE_HEAP, 0, -1, quantum_start, 0.0, 0.0, heap_bytes);
+                graph->trace_heap_bytes = heap_bytes;
             }
+        }
 
-            // Call external SIMD-optimized gain. Value evaluated at the current
-            // time so gain automation (envelopes/fades) works (per-block).
-            processGainNode(
-                node.state->gain_state,
-                output,  // input
-                output,  // output (in-place)
-                frame_count,
-                param_value_now(graph, node.state, PARAM_GAIN, node.state->gain),
-                has_input
-            );
+        // Recompile here rather than once per call: reclaiming released nodes at
+        // the end of a quantum changes the graph mid-block.
+        if (graph->schedule_dirty) {
+            compileSchedule(graph);
+            graph->schedule_dirty = false;
         }
 
-    } else if (node.type == 3) { // buffer_source
-        if (!node.state || !node.state->buffer_source_state) {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        } else {
-            // Update current time for scheduled start/stop
-            // Use relative time for real-time contexts (same logic as getGraphCurrentTime)
-            double current_time;
-            if (graph->is_realtime && graph->realtime_time_initialized) {
-                current_time = static_cast<double>(graph->current_sample - graph->realtime_start_sample)
-                             / static_cast<double>(graph->sample_rate);
+        // Planar output is mixed into the arena's scratch slot, free by the
+        // time the destination runs.
+        float* quantum_output = planar_stride ? graph->arena : output + static_cast<size_t>(offset) * graph->channels;
+
+        if (graph->schedule.empty()) {
+            if (planar_stride) {
+                for (int ch = 0; ch < graph->channels; ++ch) {
+                    memset(output + ch * planar_stride + offset, 0, quantum_frames * sizeof(float));
+                }
             } else {
-                current_time = static_cast<double>(graph->current_sample) / static_cast<double>(graph->sample_rate);
+                memset(quantum_output, 0, quantum_frames * graph->channels * sizeof(float));
             }
-            setBufferSourceCurrentTime(node.state->buffer_source_state, current_time);
-            processBufferSourceNode(node.state->buffer_source_state, output, frame_count);
+            graph->current_sample += quantum_frames;
+            continue;
         }
 
-    } else if (node.type == 4) { // biquad_filter
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->biquad_state) {
-            processBiquadFilterNode(node.state->biquad_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        }
+        // Current time for scheduled start/stop, evaluated once per quantum.
+        const double current_time = graphTime(graph);
 
-    } else if (node.type == 5) { // delay
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
+        // One linear walk: the destination is the last step and renders straight
+        // into the caller's buffer.
+        const size_t dest_step = graph->schedule.size() - 1;
+        for (size_t i = 0; i < dest_step; ++i) {
+            const ScheduledNode& step = graph->schedule[i];
+            graph->step_silent[i] = !processStep(graph, step, step.output, quantum_frames, current_time);
         }
-        if (node.state && node.state->delay_state) {
-            processDelayNode(node.state->delay_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
+        processStep(graph, graph->schedule[dest_step], quantum_output, quantum_frames, current_time);
+        if (planar_stride) {
+            deinterleaveStrided(quantum_output, output + offset, planar_stride, quantum_frames, graph->channels);
         }
 
-    } else if (node.type == 6) { // wave_shaper
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->waveshaper_state) {
-            processWaveShaperNode(node.state->waveshaper_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
+        // Always increment sample counter after processing
+        // For offline contexts: this advances time automatically
+        // For real-time contexts: this ensures timing within each render block is correct
+        //   (JavaScript will reset current_sample to wall-clock time before next render)
+        graph->current_sample += quantum_frames;
+
+        if (!graph->released_nodes.empty()) {
+            reclaimReleasedNodes(graph);
         }
 
-    } else if (node.type == 7) { // stereo_panner
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
+        // Heap sampling is the profiler's cost, not the graph's
+        const double quantum_ms =
+            emscripten_get_now() - quantum_start - (graph->heap_sample_ms - heap_sampled_before);
+        if (graph->tracing) {
+            traceEvent(graph, TRACE_QUANTUM, 0, -1, quantum_start, quantum_ms, current_time, quantum_frames);
         }
-        if (node.state && node.state->stereo_panner_state) {
-            processStereoPannerNode(node.state->stereo_panner_state, output, output, frame_count, graph->channels, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
+        if (graph->profiling) {
+            const double overhead = quantum_ms - graph->quantum_node_ms;
+            NodeProfile& profile = graph->overhead_profile;
+            profile.calls++;
+            profile.total_ms += overhead;
+            if (overhead > profile.max_ms) profile.max_ms = overhead;
         }
+    }
+}
 
-    } else if (node.type == 8) { // constant_source
-        if (!node.state || !node.state->constant_source_state) {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        } else {
-            processConstantSourceNode(node.state->constant_source_state, output, frame_count);
-        }
+EMSCRIPTEN_KEEPALIVE
+void processGraph(int graph_id, float* output, int frame_count) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) {
+        return;
+    }
 
-    } else if (node.type == 9) { // convolver
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->convolver_state) {
-            processConvolverNode(node.state->convolver_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        }
+    AudioGraph* graph = it->second;
+    const double start = emscripten_get_now();
+    const double heap_sampled_before = graph->heap_sample_ms;
+    renderGraph(graph, output, frame_count);
+    const double render_ms = emscripten_get_now() - start - (graph->heap_sample_ms - heap_sampled_before);
+
+    if (frame_count > 0) {
+        RenderStats& stats = graph->render_stats;
+        const double audio_ms = frame_count * 1000.0 / graph->sample_rate;
+        const double load = render_ms / audio_ms;
+        stats.render_ms += render_ms;
+        stats.audio_ms += audio_ms;
+        if (load > stats.peak_load) stats.peak_load = load;
+        stats.calls++;
+    }
+}
 
-    } else if (node.type == 10) { // dynamics_compressor
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->compressor_state) {
-            processDynamicsCompressorNode(node.state->compressor_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        }
+// Copy the render timing gathered since the last call into out[0..3] (ms spent
+// rendering, ms of audio rendered, peak load, processGraph calls) and start a
+// new period.
+EMSCRIPTEN_KEEPALIVE
+void takeRenderStats(int graph_id, double* out) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) {
+        out[0] = out[1] = out[2] = out[3] = 0.0;
+        return;
+    }
 
-    } else if (node.type == 11) { // analyser
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->analyser_state) {
-            processAnalyserNode(node.state->analyser_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        }
+    RenderStats& stats = it->second->render_stats;
+    out[0] = stats.render_ms;
+    out[1] = stats.audio_ms;
+    out[2] = stats.peak_load;
+    out[3] = stats.calls;
+    stats = RenderStats();
+}
 
-    } else if (node.type == 12) { // panner
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->panner_state) {
-            processPannerNode(node.state->panner_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        }
+// Progress callback for renderGraphRange: graph id, frames rendered so far,
+// total frames. From JS, a function registered with addFunction(fn, 'viii').
+typedef void (*RenderProgressCallback)(int graph_id, int frames_rendered, int total_frames);
 
-    } else if (node.type == 13) { // iir_filter
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->iir_filter_state) {
-            processIIRFilterNode(node.state->iir_filter_state, output, output, frame_count, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        }
+// Render `total_frames` frames in one call, looping over quanta natively
+// instead of crossing from JS once per quantum. If `progress` is set it is
+// called after every `progress_quanta` quanta (and once at the end), from
+// inside the render, so it must not touch the graph.
+static void renderRange(int graph_id, float* output, int total_frames, bool planar,
+                        RenderProgressCallback progress, int progress_quanta) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) {
+        return;
+    }
 
-    } else if (node.type == 14) { // channel_splitter
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->channel_splitter_state) {
-            processChannelSplitterNode(node.state->channel_splitter_state, output, output, frame_count, graph->channels, has_input);
+    AudioGraph* graph = it->second;
+    const size_t planar_stride = planar ? static_cast<size_t>(total_frames) : 0;
+    const int chunk_frames = (progress && progress_quanta > 0) ? progress_quanta * RENDER_QUANTUM : total_frames;
+    for (int done = 0; done < total_frames;) {
+        const int frames = total_frames - done < chunk_frames ? total_frames - done : chunk_frames;
+        if (planar) {
+            renderGraph(graph, output + done, frames, planar_stride);
         } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
+            renderGraph(graph, output + static_cast<size_t>(done) * graph->channels, frames);
         }
+        done += frames;
+        if (progress) progress(graph_id, done, total_frames);
+    }
+}
 
-    } else if (node.type == 15) { // channel_merger
-        auto conn_it = graph->connections.find(node_id);
-        bool has_input = (conn_it != graph->connections.end() && !conn_it->second.empty());
-        if (has_input) {
-            int source_id = conn_it->second[0];
-            processNode(graph, source_id, output, frame_count);
-        }
-        if (node.state && node.state->channel_merger_state) {
-            processChannelMergerNodeSimple(node.state->channel_merger_state, output, output, frame_count, graph->channels, has_input);
-        } else {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        }
+// Interleaved output: frame i, channel c at output[i * channels + c].
+EMSCRIPTEN_KEEPALIVE
+void renderGraphRange(int graph_id, float* output, int total_frames,
+                      RenderProgressCallback progress, int progress_quanta) {
+    renderRange(graph_id, output, total_frames, false, progress, progress_quanta);
+}
 
-    } else if (node.type == 16) { // media_stream_source
-        if (!node.state || !node.state->media_stream_source_state) {
-            memset(output, 0, frame_count * graph->channels * sizeof(float));
-        } else {
-            // Pull audio from microphone ring buffer
-            // Pass graph->channels so it can up-mix mono to stereo if needed
-            processMediaStreamSourceNode(node.state->media_stream_source_state, output, frame_count, graph->channels);
-        }
+// Planar output: `output` holds one run of `total_frames` samples per channel,
+// channel c at output + c * total_frames, ready to be viewed per channel
+// without a de-interleave pass over the whole result.
+EMSCRIPTEN_KEEPALIVE
+void renderGraphRangePlanar(int graph_id, float* output, int total_frames,
+                            RenderProgressCallback progress, int progress_quanta) {
+    renderRange(graph_id, output, total_frames, true, progress, progress_quanta);
+}
 
-    } else {
-        // Unknown node type
-        memset(output, 0, frame_count * graph->channels * sizeof(float));
+// Turn per-node profiling on or off. Turning it on starts from an empty
+// profile.
+EMSCRIPTEN_KEEPALIVE
+void setGraphProfiling(int graph_id, int enabled) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return;
+
+    AudioGraph* graph = it->second;
+    if (enabled && !graph->profiling) {
+        graph->node_profiles.clear();
+        graph->overhead_profile = NodeProfile();
+        graph->overhead_profile.kind = -1;
     }
+    graph->profiling = enabled != 0;
+}
 
-    // Cache result to prevent reprocessing if this node has multiple dependents
-    // Reuse existing vector to avoid reallocation
-    auto& cached_buffer = graph->node_buffers[node_id];
-    cached_buffer.assign(output, output + frame_count * graph->channels);
+static void appendProfileRow(std::vector<double>& rows, int handle, const NodeProfile& profile) {
+    rows.push_back(handle);
+    rows.push_back(profile.kind);
+    rows.push_back(static_cast<double>(profile.calls));
+    rows.push_back(profile.total_ms);
+    rows.push_back(profile.max_ms);
+    rows.push_back(profile.bytes);
 }
 
+// The profile gathered so far as a flat array of doubles: the row count, then
+// PROFILE_FIELDS per row (see NodeProfile). Nodes are listed until the graph is
+// destroyed or profiling is turned on again, even after they are freed. The
+// array belongs to the graph and is valid until the next call.
 EMSCRIPTEN_KEEPALIVE
-void processGraph(int graph_id, float* output, int frame_count) {
+double* getGraphProfile(int graph_id) {
     auto it = graphs.find(graph_id);
-    if (it == graphs.end()) {
-        return;
-    }
+    if (it == graphs.end()) return nullptr;
 
     AudioGraph* graph = it->second;
-
-    // Initialize real-time timing offset on first render
-    // Capture the sample position when we first start processing to establish "time zero"
-    if (graph->is_realtime && !graph->realtime_time_initialized) {
-        graph->realtime_start_sample = graph->current_sample;
-        graph->realtime_time_initialized = true;
+    std::vector<double>& rows = graph->profile_rows;
+    rows.clear();
+    rows.push_back(0);
+
+    NodeProfile by_kind[NODE_KIND_COUNT];
+    for (const auto& entry : graph->node_profiles) {
+        const NodeProfile& node = entry.second;
+        appendProfileRow(rows, entry.first, node);
+
+        NodeProfile& kind = by_kind[node.kind];
+        kind.calls += node.calls;
+        kind.total_ms += node.total_ms;
+        kind.bytes += node.bytes;
+        if (node.max_ms > kind.max_ms) kind.max_ms = node.max_ms;
+    }
+    for (int kind = 0; kind < NODE_KIND_COUNT; ++kind) {
+        if (by_kind[kind].calls == 0 && by_kind[kind].bytes == 0) continue;
+        by_kind[kind].kind = kind;
+        appendProfileRow(rows, 0, by_kind[kind]);
     }
+    appendProfileRow(rows, -1, graph->overhead_profile);
 
-    // Clear cache for next frame
-    graph->node_buffers.clear();
+    rows[0] = static_cast<double>((rows.size() - 1) / PROFILE_FIELDS);
+    return rows.data();
+}
 
-    // Ensure temp_buffer and mix_buffer are large enough. Grow if the requested
-    // block is bigger than what we have (< not !=, so we never under-size; both
-    // grown together).
-    const int buffer_size = frame_count * graph->channels;
-    if ((int)graph->temp_buffer.size() < buffer_size ||
-        (int)graph->mix_buffer.size() < buffer_size) {
-        graph->temp_buffer.resize(buffer_size);
-        graph->mix_buffer.resize(buffer_size);
-    }
-    graph->current_frame_count = frame_count;
+// Start recording trace events, keeping at most `capacity` until they are
+// taken; capacity 0 stops recording.
+EMSCRIPTEN_KEEPALIVE
+void setGraphTracing(int graph_id, int capacity) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return;
+
+    AudioGraph* graph = it->second;
+    graph->tracing = capacity > 0;
+    graph->trace_capacity = capacity > 0 ? static_cast<size_t>(capacity) : 0;
+    graph->trace_heap_bytes = 0.0;  // record the heap size again from here
+}
 
-    // Process destination node (pulls entire graph)
-    processNode(graph, graph->dest_id, output, frame_count);
+// The events recorded since the last call as a flat array of doubles: the
+// event count, the number dropped for lack of room, then TRACE_FIELDS per
+// event. Valid until the next call; the graph starts over with an empty log.
+EMSCRIPTEN_KEEPALIVE
+double* takeGraphTrace(int graph_id) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return nullptr;
 
-    // Always increment sample counter after processing
-    // For offline contexts: this advances time automatically
-    // For real-time contexts: this ensures timing within each render block is correct
-    //   (JavaScript will reset current_sample to wall-clock time before next render)
-    graph->current_sample += frame_count;
+    AudioGraph* graph = it->second;
+    std::vector<double>& rows = graph->trace_rows;
+    rows.clear();
+    rows.reserve(2 + graph->trace_events.size() * TRACE_FIELDS);
+    rows.push_back(static_cast<double>(graph->trace_events.size()));
+    rows.push_back(graph->trace_dropped);
+    for (const TraceEvent& event : graph->trace_events) {
+        rows.push_back(event.phase);
+        rows.push_back(event.handle);
+        rows.push_back(event.handle > 0 ? handleKind(event.handle) : -1);
+        rows.push_back(event.param);
+        rows.push_back(event.ts);
+        rows.push_back(event.dur);
+        rows.push_back(event.when);
+        rows.push_back(event.value);
+    }
+    graph->trace_events.clear();
+    graph->trace_dropped = 0.0;
+    return rows.data();
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -1116,21 +2309,25 @@ void setGraphCurrentTime(int graph_id, double time) {
     }
 }
 
+// Give a buffer source or convolver `buffer_data` (interleaved frames) to play
+// or convolve with. The graph takes ownership of the block, which must come
+// from malloc; it is freed once the node no longer needs it.
 EMSCRIPTEN_KEEPALIVE
 void setNodeBuffer(int graph_id, int node_id, float* buffer_data, int buffer_frames, int buffer_channels) {
+    if (!buffer_data) return;
     auto it = graphs.find(graph_id);
-    if (it == graphs.end()) return;
-
-    AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
-
-    Node& node = node_it->second;
-    if (node.type == 3 && node.state && node.state->buffer_source_state) { // buffer_source
-        setBufferSourceBuffer(node.state->buffer_source_state, buffer_data, buffer_frames, buffer_channels);
-    } else if (node.type == 9 && node.state && node.state->convolver_state) { // convolver
-        setConvolverBuffer(node.state->convolver_state, buffer_data, buffer_frames, buffer_channels);
+    if (it == graphs.end()) {
+        free(buffer_data);
+        return;
     }
+
+    // An unregistered sample; this call holds the only reference until the
+    // node takes one
+    SampleData* sample = new SampleData{buffer_data, buffer_frames, buffer_channels, 1};
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (table) useSample(it->second, node_id, *table, dense, sample);
+    releaseSample(sample);
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -1139,25 +2336,21 @@ void setIIRFilterCoefficients(int graph_id, int node_id, float* feedforward, int
     if (it == graphs.end()) return;
 
     AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
-
-    Node& node = node_it->second;
-    if (node.type == 13 && node.state) { // iir_filter
-        // Destroy old IIR filter state
-        if (node.state->iir_filter_state) {
-            destroyIIRFilterNode(node.state->iir_filter_state);
-        }
-        // Create new IIR filter with updated coefficients
-        node.state->iir_filter_state = createIIRFilterNode(
-            graph->sample_rate,
-            graph->channels,
-            feedforward,
-            feedforward_length,
-            feedback,
-            feedback_length
-        );
-    }
+    int dense;
+    NodeTable* table = findNode(graph, node_id, dense);
+    if (!table || table->kind != NODE_IIR_FILTER) return;
+
+    // Destroy old IIR filter state
+    destroyKernel(NODE_IIR_FILTER, table->kernels[dense]);
+    // Create new IIR filter with updated coefficients
+    table->kernels[dense] = createIIRFilterNode(
+        graph->sample_rate,
+        graph->channels,
+        feedforward,
+        feedforward_length,
+        feedback,
+        feedback_length
+    );
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -1165,85 +2358,82 @@ void setMediaStreamSourceState(int graph_id, int node_id, MediaStreamSourceNodeS
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
 
-    AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
-
-    Node& node = node_it->second;
-    if (node.type == 16 && node.state) { // media_stream_source
-        node.state->media_stream_source_state = wasm_state;
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (table && table->kind == NODE_MEDIA_STREAM_SOURCE) {
+        table->kernels[dense] = wasm_state;
     }
 }
 
+// Add an AudioBuffer's PCM (interleaved frames) to the graph's sample store
+// under `buffer_id`. The graph takes ownership of the block, which JS has
+// malloc'd and written once; buffer sources and convolvers then refer to it
+// by id (setNodeBufferId) and nothing is copied again. Registering an id
+// again replaces its PCM for nodes given the id later.
 EMSCRIPTEN_KEEPALIVE
 void registerBuffer(int graph_id, int buffer_id, float* buffer_data, int buffer_frames, int buffer_channels) {
+    if (!buffer_data) return;
     auto it = graphs.find(graph_id);
-    if (it == graphs.end()) return;
-
-    AudioGraph* graph = it->second;
-
-    // COPY the buffer data — own it. buffer_data points into a JS-managed typed
-    // array on the WASM heap; aliasing it and then free()ing it in destroyAudioGraph
-    // (which frees bd.data) is an invalid free of memory we didn't malloc, and the
-    // JS array may be collected/reused out from under us. Copy it (free any prior
-    // buffer for the same id first), guard bad sizes.
-    if (!buffer_data || buffer_frames <= 0 || buffer_channels <= 0) return;
-    size_t total = (size_t)buffer_frames * (size_t)buffer_channels;
-    auto existing = graph->buffers.find(buffer_id);
-    if (existing != graph->buffers.end() && existing->second.data) {
-        free(existing->second.data);
+    if (it == graphs.end() || buffer_frames <= 0 || buffer_channels <= 0) {
+        free(buffer_data);
+        return;
     }
-    BufferData bd;
-    bd.data = (float*)malloc(total * sizeof(float));
-    if (!bd.data) return;
-    memcpy(bd.data, buffer_data, total * sizeof(float));
-    bd.frames = buffer_frames;
-    bd.channels = buffer_channels;
 
-    graph->buffers[buffer_id] = bd;
+    SampleData*& entry = it->second->samples[buffer_id];
+    releaseSample(entry);
+    entry = new SampleData{buffer_data, buffer_frames, buffer_channels, 1};
 }
 
+// Drop the registration of `buffer_id` (its AudioBuffer is gone). The PCM is
+// freed once no buffer source plays it any more.
 EMSCRIPTEN_KEEPALIVE
-void setNodeBufferId(int graph_id, int node_id, int buffer_id) {
+void releaseBuffer(int graph_id, int buffer_id) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
 
     AudioGraph* graph = it->second;
+    auto sample = graph->samples.find(buffer_id);
+    if (sample == graph->samples.end()) return;
+    releaseSample(sample->second);
+    graph->samples.erase(sample);
+}
 
-    // Find the buffer
-    auto buf_it = graph->buffers.find(buffer_id);
-    if (buf_it == graph->buffers.end()) return;
-
-    BufferData& bd = buf_it->second;
+EMSCRIPTEN_KEEPALIVE
+void setNodeBufferId(int graph_id, int node_id, int buffer_id) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return;
 
-    // Find the node
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
+    AudioGraph* graph = it->second;
+    auto sample = graph->samples.find(buffer_id);
+    if (sample == graph->samples.end()) return;
 
-    Node& node = node_it->second;
-    if (node.type == 3 && node.state && node.state->buffer_source_state) {
-        // Set buffer on buffer source node
-        setBufferSourceBuffer(node.state->buffer_source_state, bd.data, bd.frames, bd.channels);
-    }
+    int dense;
+    NodeTable* table = findNode(graph, node_id, dense);
+    if (table) useSample(graph, node_id, *table, dense, sample->second);
 }
 
 /*
- * PeriodicWave (custom oscillator waveform).
+ * PeriodicWave (custom oscillator waveform) from its Fourier coefficients.
  *
- * setPeriodicWave existed on the oscillator node but was never reachable
- * through the graph API, so OscillatorNode.setPeriodicWave had nothing to call
- * and custom waveforms could not be used at all.
+ * The band-limited tables are synthesized here rather than in JS, and cached
+ * per graph by coefficients: oscillators playing the same wave share one set
+ * of tables. `real` and `imag` are only read during the call.
  */
 EMSCRIPTEN_KEEPALIVE
-void setNodePeriodicWave(int graph_id, int node_id, float* wavetable, int size) {
+void setNodePeriodicWave(int graph_id, int node_id, const float* real, const float* imag, int count, int normalize) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
-    auto node_it = it->second->nodes.find(node_id);
-    if (node_it == it->second->nodes.end()) return;
-    Node& node = node_it->second;
-    if (node.type != 1 || !node.state || !node.state->osc_state) return;  // oscillator only
-    if (!wavetable || size <= 0) return;
-    setPeriodicWave(node.state->osc_state, wavetable, size);
+    AudioGraph* graph = it->second;
+    int dense;
+    NodeTable* table = findNode(graph, node_id, dense);
+    if (!table || table->kind != NODE_OSCILLATOR || !table->kernels[dense]) return;  // oscillator only
+    if (!real || !imag || count < 2) return;
+
+    OscillatorNodeState* osc = static_cast<OscillatorNodeState*>(table->kernels[dense]);
+    WaveTableSet* tables = acquirePeriodicWave(graph, real, imag, count, normalize != 0);
+    if (!tables) return;
+    releasePeriodicWave(graph, getOscillatorWaveTables(osc));
+    setOscillatorWaveTables(osc, tables);
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -1251,36 +2441,73 @@ void setWaveShaperCurve(int graph_id, int node_id, float* curve_data, int curve_
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
 
-    AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
-
-    Node& node = node_it->second;
-    if (node.type == 6 && node.state && node.state->waveshaper_state) { // waveshaper
-        setWaveShaperCurve_node(node.state->waveshaper_state, curve_data, curve_length);
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (table && table->kind == NODE_WAVE_SHAPER && table->kernels[dense]) {
+        setWaveShaperCurve_node(static_cast<WaveShaperNodeState*>(table->kernels[dense]), curve_data, curve_length);
     }
 }
 
+// Set a NodeProperty. Properties a node's kind doesn't have are ignored.
 EMSCRIPTEN_KEEPALIVE
-void setWaveShaperOversample(int graph_id, int node_id, const char* oversample_str) {
+void setNodeProperty(int graph_id, int node_id, int property_id, float value) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
 
-    AudioGraph* graph = it->second;
-    auto node_it = graph->nodes.find(node_id);
-    if (node_it == graph->nodes.end()) return;
-
-    // Convert string to oversample enum
-    int oversample_value = 0; // 0 = none
-    if (oversample_str) {
-        std::string os(oversample_str);
-        if (os == "2x") oversample_value = 1;
-        else if (os == "4x") oversample_value = 2;
-    }
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (!table || !table->kernels[dense]) return;
+    void* kernel = table->kernels[dense];
+    const int index = static_cast<int>(value);
 
-    Node& node = node_it->second;
-    if (node.type == 6 && node.state && node.state->waveshaper_state) { // waveshaper
-        setWaveShaperOversample_node(node.state->waveshaper_state, oversample_value);
+    switch (table->kind) {
+        case NODE_OSCILLATOR:
+            if (property_id == PROP_TYPE && index >= 0 && index <= 3) {
+                setOscillatorWaveType(static_cast<OscillatorNodeState*>(kernel), index);
+            }
+            break;
+        case NODE_BIQUAD_FILTER:
+            if (property_id == PROP_TYPE && index >= 0 && index <= 7) {
+                setBiquadFilterType(static_cast<BiquadFilterNodeState*>(kernel), index);
+            }
+            break;
+        case NODE_WAVE_SHAPER:
+            if (property_id == PROP_OVERSAMPLE && index >= 0 && index <= 2) {
+                setWaveShaperOversample_node(static_cast<WaveShaperNodeState*>(kernel), index);
+            }
+            break;
+        case NODE_CONVOLVER:
+            if (property_id == PROP_NORMALIZE) {
+                setConvolverNormalize(static_cast<ConvolverNodeState*>(kernel), value != 0.0f);
+            }
+            break;
+        case NODE_ANALYSER: {
+            AnalyserNodeState* analyser = static_cast<AnalyserNodeState*>(kernel);
+            switch (property_id) {
+                case PROP_FFT_SIZE:                setAnalyserFFTSize(analyser, index); break;
+                case PROP_MIN_DECIBELS:            setAnalyserMinDecibels(analyser, value); break;
+                case PROP_MAX_DECIBELS:            setAnalyserMaxDecibels(analyser, value); break;
+                case PROP_SMOOTHING_TIME_CONSTANT: setAnalyserSmoothingTimeConstant(analyser, value); break;
+                default: break;
+            }
+            break;
+        }
+        case NODE_PANNER: {
+            PannerNodeState* panner = static_cast<PannerNodeState*>(kernel);
+            if (property_id == PROP_PANNING_MODEL && index >= 0 && index <= 1) {
+                setPannerPanningModel(panner, index);
+            } else if (property_id == PROP_DISTANCE_MODEL && index >= 0 && index <= 2) {
+                setPannerDistanceModel(panner, index);
+            }
+            break;
+        }
+        case NODE_BUFFER_SOURCE:
+            if (property_id == PROP_INTERPOLATION && index >= 0 && index <= 2) {
+                setBufferSourceInterpolation(static_cast<BufferSourceNodeState*>(kernel), index);
+            }
+            break;
+        default:
+            break;
     }
 }
 
@@ -1288,66 +2515,14 @@ void setWaveShaperOversample(int graph_id, int node_id, const char* oversample_s
 // Uses SIMD for optimal performance
 EMSCRIPTEN_KEEPALIVE
 void deinterleaveAudio(float* interleaved, float* planar, int frame_count, int num_channels) {
-    if (num_channels == 1) {
-        // Mono - just copy
-        memcpy(planar, interleaved, frame_count * sizeof(float));
-        return;
-    }
-
-    if (num_channels == 2) {
-        // Stereo - optimized SIMD path
-#ifdef __wasm_simd128__
-        int simd_count = frame_count / 4; // Process 4 frames at a time
-        int simd_frames = simd_count * 4;
-
-        float* left = planar;
-        float* right = planar + frame_count;
-
-        for (int i = 0; i < simd_frames; i += 4) {
-            // Load 8 floats: L0,R0,L1,R1,L2,R2,L3,R3
-            v128_t data0 = wasm_v128_load(&interleaved[i * 2]);
-            v128_t data1 = wasm_v128_load(&interleaved[i * 2 + 4]);
-
-            // Shuffle to separate L and R
-            // data0: L0,R0,L1,R1  data1: L2,R2,L3,R3
-            // Want:  L0,L1,L2,L3 and R0,R1,R2,R3
-            v128_t left_vec = wasm_i32x4_shuffle(data0, data1, 0, 2, 4, 6);  // L0,L1,L2,L3
-            v128_t right_vec = wasm_i32x4_shuffle(data0, data1, 1, 3, 5, 7); // R0,R1,R2,R3
-
-            wasm_v128_store(&left[i], left_vec);
-            wasm_v128_store(&right[i], right_vec);
-        }
-
-        // Handle remaining frames
-        for (int i = simd_frames; i < frame_count; i++) {
-            left[i] = interleaved[i * 2];
-            right[i] = interleaved[i * 2 + 1];
-        }
-#else
-        // Scalar fallback for stereo
-        float* left = planar;
-        float* right = planar + frame_count;
-        for (int i = 0; i < frame_count; i++) {
-            left[i] = interleaved[i * 2];
-            right[i] = interleaved[i * 2 + 1];
-        }
-#endif
-    } else {
-        // Generic multi-channel (scalar - less common case)
-        for (int ch = 0; ch < num_channels; ch++) {
-            float* channel_out = planar + ch * frame_count;
-            for (int i = 0; i < frame_count; i++) {
-                channel_out[i] = interleaved[i * num_channels + ch];
-            }
-        }
-    }
+    deinterleaveStrided(interleaved, planar, frame_count, frame_count, num_channels);
 }
 
 // Disconnect a source from a destination, or from everything.
 //
 // Mirrors AudioNode.disconnect() in the Web Audio spec:
 //   dest_id >= 0  remove source_id -> dest_id (that edge only)
-//   dest_id <  0  remove source_id from EVERY destination it feeds
+//   dest_id <  0  remove source_id from EVERY destination it feeds, params too
 //
 // Only ONE instance of the edge is removed per call, because connecting the
 // same pair twice is legal and produces two summed edges; disconnect() undoes
@@ -1359,53 +2534,121 @@ void disconnectNodes(int graph_id, int source_id, int dest_id) {
     if (it == graphs.end()) return;
     AudioGraph* graph = it->second;
 
+    int source_dense;
+    NodeTable* source = findNode(graph, source_id, source_dense);
+    if (!source) return;
+    std::vector<int>& dests = source->outputs[source_dense];
+
     if (dest_id >= 0) {
-        auto conn_it = graph->connections.find(dest_id);
-        if (conn_it == graph->connections.end()) return;
-        std::vector<int>& sources = conn_it->second;
-        for (size_t i = 0; i < sources.size(); ++i) {
-            if (sources[i] == source_id) {
-                sources.erase(sources.begin() + i);
-                return;   // one edge per call
-            }
+        auto out_it = std::find(dests.begin(), dests.end(), dest_id);
+        if (out_it == dests.end()) return;
+        dests.erase(out_it);   // one edge per call
+
+        int dense;
+        NodeTable* table = findNode(graph, dest_id, dense);
+        if (table) {
+            std::vector<int>& sources = table->inputs[dense];
+            auto in_it = std::find(sources.begin(), sources.end(), source_id);
+            if (in_it != sources.end()) sources.erase(in_it);
         }
+        graph->schedule_dirty = true;
         return;
     }
 
-    // dest_id < 0: drop this source everywhere it appears.
-    for (auto& entry : graph->connections) {
-        std::vector<int>& sources = entry.second;
-        for (size_t i = 0; i < sources.size(); ) {
-            if (sources[i] == source_id) sources.erase(sources.begin() + i);
-            else ++i;
-        }
+    // dest_id < 0: drop this source everywhere it appears, params included.
+    for (int dest : dests) {
+        int dense;
+        NodeTable* table = findNode(graph, dest, dense);
+        if (!table) continue;
+        std::vector<int>& sources = table->inputs[dense];
+        sources.erase(std::remove(sources.begin(), sources.end(), source_id), sources.end());
+    }
+    dests.clear();
+    for (int dest : source->param_outputs[source_dense]) {
+        int dense;
+        NodeTable* table = findNode(graph, dest, dense);
+        if (!table) continue;
+        std::vector<ParamInput>& inputs = table->param_inputs[dense];
+        inputs.erase(std::remove_if(inputs.begin(), inputs.end(),
+                                    [source_id](const ParamInput& in) { return in.source == source_id; }),
+                     inputs.end());
     }
+    source->param_outputs[source_dense].clear();
+    graph->schedule_dirty = true;
 }
 
-// Stubs for compatibility.
-//
-// setNodePeriodicWave USED to be one of these: a no-op that accepted a custom
-// waveform and silently discarded it, so OscillatorNode.setPeriodicWave
-// appeared to work and changed nothing. It is implemented above now.
-EMSCRIPTEN_KEEPALIVE void connectToParam(int, int, int, const char*, int) {}
-EMSCRIPTEN_KEEPALIVE void setNodeProperty(int, int, const char*, float) {}
-EMSCRIPTEN_KEEPALIVE void setNodeStringProperty(int, int, const char*, const char*) {}
+// Connect a node's output to a param of another node (AudioNode.connect(param)).
+// The param becomes audio-rate: its value each frame is its own value plus the
+// sum of everything connected to it. Connecting the same pair twice adds the
+// signal twice, as with node connections. Params the kind doesn't keep are
+// ignored. output_idx is accepted for symmetry with connectNodes; every node
+// here has a single output.
+EMSCRIPTEN_KEEPALIVE
+void connectToParam(int graph_id, int source_id, int dest_id, int param_id, int output_idx) {
+    (void)output_idx;
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return;
+
+    AudioGraph* graph = it->second;
+    int source_dense, dest_dense;
+    NodeTable* source = findNode(graph, source_id, source_dense);
+    NodeTable* dest = findNode(graph, dest_id, dest_dense);
+    if (!source || !dest) return;
+    const int slot = paramSlot(dest->kind, param_id);
+    if (slot < 0) return;
+
+    dest->param_inputs[dest_dense].push_back({source_id, slot});
+    source->param_outputs[source_dense].push_back(dest_id);
+    graph->schedule_dirty = true;
+}
+
+// Undo one connectToParam (AudioNode.disconnect(param)).
+EMSCRIPTEN_KEEPALIVE
+void disconnectFromParam(int graph_id, int source_id, int dest_id, int param_id) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end()) return;
+
+    AudioGraph* graph = it->second;
+    int source_dense, dest_dense;
+    NodeTable* source = findNode(graph, source_id, source_dense);
+    NodeTable* dest = findNode(graph, dest_id, dest_dense);
+    if (!source || !dest) return;
+    const int slot = paramSlot(dest->kind, param_id);
+
+    std::vector<ParamInput>& inputs = dest->param_inputs[dest_dense];
+    auto in_it = std::find_if(inputs.begin(), inputs.end(), [source_id, slot](const ParamInput& in) {
+        return in.source == source_id && in.slot == slot;
+    });
+    if (in_it == inputs.end()) return;
+    inputs.erase(in_it);
+
+    std::vector<int>& dests = source->param_outputs[source_dense];
+    auto out_it = std::find(dests.begin(), dests.end(), dest_id);
+    if (out_it != dests.end()) dests.erase(out_it);
+    graph->schedule_dirty = true;
+}
 
 // Schedule a param automation event, wiring the AudioParamState automation into
 // the graph. kind: 0=setValueAtTime, 1=linearRamp, 2=exponentialRamp,
-// 3=setTarget, 4=cancelScheduledValues. The process loop reads the value at the
-// current time (param_value_now), so the param actually changes over time
-// (envelopes, ramps, sweeps). (Replaces the old string-based no-op stubs.)
+// 3=setTarget, 4=cancelScheduledValues. The process loop renders the param
+// frame by frame over each quantum (computeParamRates), so the param actually
+// changes over time (envelopes, ramps, sweeps). (Replaces the old string-based no-op stubs.)
 EMSCRIPTEN_KEEPALIVE
 void scheduleParamEvent(int graph_id, int node_id, int param_id, int kind,
                         float value, double time, float timeConstant) {
     auto it = graphs.find(graph_id);
     if (it == graphs.end()) return;
-    auto node_it = it->second->nodes.find(node_id);
-    if (node_it == it->second->nodes.end() || !node_it->second.state) return;
-    NodeState* st = node_it->second.state;
-    AudioParamState*& ap = st->param_auto[param_id];
-    if (!ap) ap = createAudioParam(node_param_default(st, param_id), -3.4e38f, 3.4e38f);
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (!table) return;
+    int slot = paramSlot(table->kind, param_id);
+    if (slot < 0) return;
+    if (it->second->tracing) {
+        traceEvent(it->second, TRACE_PARAM, node_id, param_id, emscripten_get_now(), 0.0, time, value);
+    }
+    ParamSlot& param = nodeParams(*table, dense)[slot];
+    if (!param.automation) param.automation = createAudioParam(param.value, -3.4e38f, 3.4e38f);
+    AudioParamState* ap = param.automation;
     switch (kind) {
         case 0: setParamValueAtTime(ap, value, time); break;
         case 1: linearRampToValueAtTime(ap, value, time); break;
@@ -1416,4 +2659,125 @@ void scheduleParamEvent(int graph_id, int node_id, int param_id, int kind,
     }
 }
 
+// Schedule a value curve (setValueCurveAtTime): `length` points spread over
+// [time, time + duration] as one automation event, interpolated per frame. The
+// points are copied. Not a GraphCommand: the curve's size is unbounded, so JS
+// flushes the command buffer and calls this directly, as for waveshaper curves.
+EMSCRIPTEN_KEEPALIVE
+void scheduleParamCurve(int graph_id, int node_id, int param_id, const float* values, int length,
+                        double time, double duration) {
+    auto it = graphs.find(graph_id);
+    if (it == graphs.end() || !values || length <= 0) return;
+    int dense;
+    NodeTable* table = findNode(it->second, node_id, dense);
+    if (!table) return;
+    int slot = paramSlot(table->kind, param_id);
+    if (slot < 0) return;
+    if (it->second->tracing) {
+        traceEvent(it->second, TRACE_PARAM, node_id, param_id, emscripten_get_now(), 0.0, time, values[length - 1]);
+    }
+    ParamSlot& param = nodeParams(*table, dense)[slot];
+    if (!param.automation) param.automation = createAudioParam(param.value, -3.4e38f, 3.4e38f);
+    setValueCurveAtTime(param.automation, values, length, time, duration);
+}
+
+// Apply a batch of graph mutations written by JS (see GraphCommand) in one
+// call, instead of one call per mutation. Commands apply in order; a
+// truncated trailing command is ignored.
+EMSCRIPTEN_KEEPALIVE
+void applyCommands(int graph_id, const uint8_t* commands, int length) {
+    if (graphs.find(graph_id) == graphs.end() || length <= 0) return;
+
+    CommandReader in{commands, commands + length};
+    while (in.has(4)) {
+        const uint32_t op = in.read<uint32_t>();
+        switch (op) {
+            case CMD_SET_PARAM: {
+                if (!in.has(12)) return;
+                const int node = in.read<int32_t>();
+                const int param = in.read<int32_t>();
+                setNodeParameter(graph_id, node, param, in.read<float>());
+                break;
+            }
+            case CMD_SCHEDULE_PARAM: {
+                if (!in.has(28)) return;
+                const int node = in.read<int32_t>();
+                const int param = in.read<int32_t>();
+                const int kind = in.read<int32_t>();
+                const float value = in.read<float>();
+                const double time = in.read<double>();
+                scheduleParamEvent(graph_id, node, param, kind, value, time, in.read<float>());
+                break;
+            }
+            case CMD_START:
+            case CMD_STOP: {
+                if (!in.has(12)) return;
+                const int node = in.read<int32_t>();
+                const double when = in.read<double>();
+                if (op == CMD_START) {
+                    startNode(graph_id, node, when);
+                } else {
+                    stopNode(graph_id, node, when);
+                }
+                break;
+            }
+            case CMD_CONNECT: {
+                if (!in.has(16)) return;
+                const int source = in.read<int32_t>();
+                const int dest = in.read<int32_t>();
+                const int output = in.read<int32_t>();
+                connectNodes(graph_id, source, dest, output, in.read<int32_t>());
+                break;
+            }
+            case CMD_DISCONNECT: {
+                if (!in.has(8)) return;
+                const int source = in.read<int32_t>();
+                disconnectNodes(graph_id, source, in.read<int32_t>());
+                break;
+            }
+            case CMD_RELEASE:
+            case CMD_DESTROY: {
+                if (!in.has(4)) return;
+                const int node = in.read<int32_t>();
+                if (op == CMD_RELEASE) {
+                    releaseNode(graph_id, node);
+                } else {
+                    destroyNode(graph_id, node);
+                }
+                break;
+            }
+            case CMD_SET_BUFFER_ID: {
+                if (!in.has(8)) return;
+                const int node = in.read<int32_t>();
+                setNodeBufferId(graph_id, node, in.read<int32_t>());
+                break;
+            }
+            case CMD_SET_PROPERTY: {
+                if (!in.has(12)) return;
+                const int node = in.read<int32_t>();
+                const int property = in.read<int32_t>();
+                setNodeProperty(graph_id, node, property, in.read<float>());
+                break;
+            }
+            case CMD_CONNECT_PARAM: {
+                if (!in.has(16)) return;
+                const int source = in.read<int32_t>();
+                const int dest = in.read<int32_t>();
+                const int param = in.read<int32_t>();
+                connectToParam(graph_id, source, dest, param, in.read<int32_t>());
+                break;
+            }
+            case CMD_DISCONNECT_PARAM: {
+                if (!in.has(12)) return;
+                const int source = in.read<int32_t>();
+                const int dest = in.read<int32_t>();
+                disconnectFromParam(graph_id, source, dest, in.read<int32_t>());
+                break;
+            }
+            default:
+                return;  // unknown opcode: can't know its size, stop here
+        }
+    }
+}
+
 } // extern "C"
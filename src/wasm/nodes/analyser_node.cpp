@@ -102,6 +102,13 @@ void setAnalyserSmoothingTimeConstant(AnalyserNodeState* state, float smoothing)
     if (state) state->smoothing_time_constant = fmaxf(0.0f, fminf(1.0f, smoothing));
 }
 
+// Frames of silence after which the analysis window holds nothing but zeros,
+// so skipping the node no longer changes what getFloat*Data report.
+EMSCRIPTEN_KEEPALIVE
+int getAnalyserTailFrames(AnalyserNodeState* state) {
+    return state ? state->fft_size : 0;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void processAnalyserNode(
     AnalyserNodeState* state,
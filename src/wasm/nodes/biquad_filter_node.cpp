@@ -224,6 +224,31 @@ void setBiquadFilterDetune(BiquadFilterNodeState* state, float detune) {
     state->coefficients_dirty = true;
 }
 
+// Frames the filter keeps ringing after its input goes silent, until the
+// impulse response has decayed below -120 dB. Set by the slower of the two
+// poles of 1 + a1 z^-1 + a2 z^-2. -1 if the filter is unstable and never
+// settles.
+EMSCRIPTEN_KEEPALIVE
+int getBiquadFilterTailFrames(BiquadFilterNodeState* state) {
+    if (!state) return 0;
+    if (state->coefficients_dirty) computeCoefficients(state);
+
+    const double a1 = state->a1;
+    const double a2 = state->a2;
+    const double disc = a1 * a1 - 4.0 * a2;
+    double radius;
+    if (disc < 0.0) {
+        radius = sqrt(a2);  // complex pair: |p|^2 = a2
+    } else {
+        const double root = sqrt(disc);
+        radius = fmax(fabs((-a1 + root) * 0.5), fabs((-a1 - root) * 0.5));
+    }
+
+    if (radius >= 1.0) return -1;
+    if (radius < 1e-6) return 2;  // no feedback to speak of: just the b1/b2 taps
+    return static_cast<int>(ceil(log(1e-6) / log(radius))) + 2;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void processBiquadFilterNode(
     BiquadFilterNodeState* state,
@@ -316,4 +341,57 @@ void processBiquadFilterNode(
     }
 }
 
+// Filter with audio-rate frequency, Q, gain and detune (filter sweeps from an
+// LFO or envelope): coefficients follow the params frame by frame, recomputed
+// only when a value actually changes. The node's own param values are left as
+// they were.
+EMSCRIPTEN_KEEPALIVE
+void processBiquadFilterNodeARate(
+    BiquadFilterNodeState* state,
+    float* input,
+    float* output,
+    int frame_count,
+    const float* frequency,
+    const float* q,
+    const float* gain,
+    const float* detune
+) {
+    if (!state) return;
+
+    const float frequency_value = state->frequency;
+    const float q_value = state->Q;
+    const float gain_value = state->gain;
+    const float detune_value = state->detune;
+    const int channels = state->channels;
+
+    for (int i = 0; i < frame_count; i++) {
+        if (state->coefficients_dirty || frequency[i] != state->frequency || q[i] != state->Q ||
+            gain[i] != state->gain || detune[i] != state->detune) {
+            state->frequency = frequency[i];
+            state->Q = q[i];
+            state->gain = gain[i];
+            state->detune = detune[i];
+            computeCoefficients(state);
+        }
+
+        for (int ch = 0; ch < channels; ch++) {
+            const int idx = i * channels + ch;
+            const float x = input[idx];
+            const float y = state->b0 * x + state->b1 * state->x1[ch] + state->b2 * state->x2[ch]
+                          - state->a1 * state->y1[ch] - state->a2 * state->y2[ch];
+            output[idx] = y;
+            state->x2[ch] = state->x1[ch];
+            state->x1[ch] = x;
+            state->y2[ch] = state->y1[ch];
+            state->y1[ch] = y;
+        }
+    }
+
+    state->frequency = frequency_value;
+    state->Q = q_value;
+    state->gain = gain_value;
+    state->detune = detune_value;
+    state->coefficients_dirty = true;
+}
+
 } // extern "C"
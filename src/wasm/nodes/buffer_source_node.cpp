@@ -1,11 +1,64 @@
 // AudioBufferSourceNode WASM implementation
-// Plays back audio buffer data with SIMD optimization
+// Plays back audio buffer data with SIMD optimization, resampled for
+// playbackRate/detune with linear, cubic or windowed-sinc interpolation
 
 #include <emscripten.h>
 #include <wasm_simd128.h>
 #include <cstring>
 #include <cstdio>
 #include <cmath>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Interpolation between buffer frames when the playhead is between them -
+// matches INTERPOLATION_TYPES in AudioBufferSourceNode.js
+enum class Interpolation {
+    LINEAR = 0,
+    CUBIC = 1,    // Catmull-Rom through the 4 nearest frames
+    SINC = 2      // windowed sinc, SINC_TAPS frames
+};
+
+// Windowed sinc: SINC_TAPS taps (frames index - SINC_TAPS/2 + 1 .. index +
+// SINC_TAPS/2) for each of SINC_PHASES + 1 fractional positions, Blackman
+// window, each row normalized to unity DC gain. The cutoff is the buffer's
+// Nyquist, so rates well above 1 still alias (less than linear does).
+static const int SINC_TAPS = 16;
+static const int SINC_PHASES = 1024;
+
+static const float* sincTable() {
+    static float* table = nullptr;
+    if (!table) {
+        table = new float[(SINC_PHASES + 1) * SINC_TAPS];
+        const double half = SINC_TAPS / 2;
+        for (int p = 0; p <= SINC_PHASES; ++p) {
+            float* row = table + p * SINC_TAPS;
+            double sum = 0.0;
+            for (int t = 0; t < SINC_TAPS; ++t) {
+                const double x = (t - (SINC_TAPS / 2 - 1)) - static_cast<double>(p) / SINC_PHASES;
+                const double sinc = x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+                const double window = 0.42 + 0.5 * std::cos(M_PI * x / half) + 0.08 * std::cos(2.0 * M_PI * x / half);
+                row[t] = static_cast<float>(sinc * window);
+                sum += row[t];
+            }
+            for (int t = 0; t < SINC_TAPS; ++t) row[t] = static_cast<float>(row[t] / sum);
+        }
+    }
+    return table;
+}
+
+// Frames read before and after the playhead's whole frame
+static inline int tapsBefore(Interpolation mode) {
+    return mode == Interpolation::SINC ? SINC_TAPS / 2 - 1 : (mode == Interpolation::CUBIC ? 1 : 0);
+}
+static inline int tapCount(Interpolation mode) {
+    return mode == Interpolation::SINC ? SINC_TAPS : (mode == Interpolation::CUBIC ? 4 : 2);
+}
+
+// Frames rendered per pass of the resampler
+static const int RESAMPLE_CHUNK = 128;
 
 // AudioBufferSourceNode state
 struct BufferSourceNodeState {
@@ -14,13 +67,22 @@ struct BufferSourceNodeState {
     bool is_active;
     bool loop;
 
-    // Buffer data (owned by this node)
-    float* buffer_data;
+    // Buffer data (interleaved; not owned - the graph's sample store keeps it
+    // alive while this node plays it)
+    const float* buffer_data;
     int buffer_frames;
     int buffer_channels;
 
-    // Playback position
-    int current_frame;
+    // Playback position in buffer frames (fractional when resampling)
+    double position;
+
+    // start() offset and loop region, in seconds of buffer time (the buffer
+    // is at the context's sample rate)
+    double start_offset;
+    double loop_start;
+    double loop_end;
+
+    Interpolation interpolation;
 
     // Scheduled timing
     double scheduled_start_time;
@@ -42,7 +104,11 @@ BufferSourceNodeState* createBufferSourceNode(int sample_rate, int channels) {
     state->buffer_data = nullptr;
     state->buffer_frames = 0;
     state->buffer_channels = 0;
-    state->current_frame = 0;
+    state->position = 0.0;
+    state->start_offset = 0.0;
+    state->loop_start = 0.0;
+    state->loop_end = 0.0;
+    state->interpolation = Interpolation::LINEAR;
     state->scheduled_start_time = -1.0;
     state->scheduled_stop_time = -1.0;
     state->current_time = 0.0;
@@ -54,31 +120,19 @@ BufferSourceNodeState* createBufferSourceNode(int sample_rate, int channels) {
 EMSCRIPTEN_KEEPALIVE
 void destroyBufferSourceNode(BufferSourceNodeState* state) {
     if (!state) return;
-
-    if (state->buffer_data) {
-        delete[] state->buffer_data;
-    }
-
     delete state;
 }
 
+// Play `buffer_data` (interleaved frames). The data is referenced, not copied:
+// it must stay valid until the node is given another buffer or reset.
 EMSCRIPTEN_KEEPALIVE
-void setBufferSourceBuffer(BufferSourceNodeState* state, float* buffer_data, int buffer_frames, int buffer_channels) {
+void setBufferSourceBuffer(BufferSourceNodeState* state, const float* buffer_data, int buffer_frames, int buffer_channels) {
     if (!state) return;
 
-    // Free old buffer if exists
-    if (state->buffer_data) {
-        delete[] state->buffer_data;
-    }
-
-    // Allocate and copy buffer data
-    int total_samples = buffer_frames * buffer_channels;
-    state->buffer_data = new float[total_samples];
-    memcpy(state->buffer_data, buffer_data, total_samples * sizeof(float));
-
+    state->buffer_data = buffer_data;
     state->buffer_frames = buffer_frames;
     state->buffer_channels = buffer_channels;
-    state->current_frame = 0;
+    state->position = 0.0;
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -87,7 +141,7 @@ void startBufferSource(BufferSourceNodeState* state, double when) {
     state->scheduled_start_time = when;
     state->has_started = false;
     state->has_stopped = false;
-    state->current_frame = 0;
+    state->position = std::max(0.0, state->start_offset * state->sample_rate);
     // Don't activate immediately - will activate when current_time >= scheduled_start_time
 }
 
@@ -122,6 +176,77 @@ void setBufferSourceLoop(BufferSourceNodeState* state, bool loop) {
     state->loop = loop;
 }
 
+EMSCRIPTEN_KEEPALIVE
+void setBufferSourceLoopStart(BufferSourceNodeState* state, double seconds) {
+    if (!state) return;
+    state->loop_start = seconds;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setBufferSourceLoopEnd(BufferSourceNodeState* state, double seconds) {
+    if (!state) return;
+    state->loop_end = seconds;
+}
+
+// Where in the buffer the next start() begins playing (its offset argument)
+EMSCRIPTEN_KEEPALIVE
+void setBufferSourceOffset(BufferSourceNodeState* state, double seconds) {
+    if (!state) return;
+    state->start_offset = seconds;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setBufferSourceInterpolation(BufferSourceNodeState* state, int mode) {
+    if (!state || mode < 0 || mode > 2) return;
+    state->interpolation = static_cast<Interpolation>(mode);
+}
+
+// Whether the source is playing this quantum (started, not stopped, not past
+// the end of its buffer). The graph skips idle sources.
+EMSCRIPTEN_KEEPALIVE
+bool isBufferSourceActive(BufferSourceNodeState* state) {
+    return state && state->is_active && state->buffer_data && state->buffer_frames > 0;
+}
+
+// True once the source can't produce sound any more: stopped, played to the
+// end of a non-looping buffer, or never scheduled to start. The graph uses this
+// to reclaim sources JS has let go of.
+EMSCRIPTEN_KEEPALIVE
+bool isBufferSourceFinished(BufferSourceNodeState* state, double time) {
+    if (!state || state->scheduled_start_time < 0.0) return true;
+    if (state->has_stopped) return true;
+    if (state->scheduled_stop_time >= 0.0 &&
+        time >= state->scheduled_stop_time &&
+        time >= state->scheduled_start_time) {
+        return true;
+    }
+    // Started and went inactive without a stop: ran off the end of the buffer.
+    return state->has_started && !state->is_active;
+}
+
+// Return a finished source to its just-created state (dropping its buffer) so
+// the graph can hand it out again instead of allocating a new one.
+EMSCRIPTEN_KEEPALIVE
+void resetBufferSourceNode(BufferSourceNodeState* state) {
+    if (!state) return;
+
+    state->buffer_data = nullptr;
+    state->buffer_frames = 0;
+    state->buffer_channels = 0;
+    state->is_active = false;
+    state->loop = false;
+    state->position = 0.0;
+    state->start_offset = 0.0;
+    state->loop_start = 0.0;
+    state->loop_end = 0.0;
+    state->interpolation = Interpolation::LINEAR;
+    state->scheduled_start_time = -1.0;
+    state->scheduled_stop_time = -1.0;
+    state->current_time = 0.0;
+    state->has_started = false;
+    state->has_stopped = false;
+}
+
 // Copy buffer data with SIMD optimization
 static void CopyBufferData(
     const float* src,
@@ -144,29 +269,17 @@ static void CopyBufferData(
     }
 }
 
-EMSCRIPTEN_KEEPALIVE
-void processBufferSourceNode(
-    BufferSourceNodeState* state,
-    float* output,
-    int frame_count
-) {
-    if (!state) return;
-
-    const int output_samples = frame_count * state->channels;
-
-    // If not active or no buffer, output silence
-    if (!state->is_active || !state->buffer_data || state->buffer_frames == 0) {
-        memset(output, 0, output_samples * sizeof(float));
-        return;
-    }
-
+// Playback at rate 1 from a whole frame, looping over the whole buffer: the
+// buffer is copied straight through.
+static void copyFrames(BufferSourceNodeState* state, float* output, int frame_count) {
+    int current_frame = static_cast<int>(state->position);
     int frames_written = 0;
 
     while (frames_written < frame_count) {
         // Check if we've reached the end of the buffer
-        if (state->current_frame >= state->buffer_frames) {
+        if (current_frame >= state->buffer_frames) {
             if (state->loop) {
-                state->current_frame = 0;
+                current_frame = 0;
             } else {
                 // Fill rest with silence
                 int remaining_samples = (frame_count - frames_written) * state->channels;
@@ -177,7 +290,7 @@ void processBufferSourceNode(
         }
 
         // Calculate how many frames we can copy from current position
-        int frames_available = state->buffer_frames - state->current_frame;
+        int frames_available = state->buffer_frames - current_frame;
         int frames_to_copy = (frame_count - frames_written < frames_available)
                            ? (frame_count - frames_written)
                            : frames_available;
@@ -185,7 +298,7 @@ void processBufferSourceNode(
         // Handle channel mismatch
         if (state->buffer_channels == state->channels) {
             // Same channel count - direct SIMD copy
-            const float* src = &state->buffer_data[state->current_frame * state->buffer_channels];
+            const float* src = &state->buffer_data[current_frame * state->buffer_channels];
             float* dst = &output[frames_written * state->channels];
             int samples_to_copy = frames_to_copy * state->channels;
 
@@ -194,7 +307,7 @@ void processBufferSourceNode(
         } else if (state->buffer_channels == 1 && state->channels > 1) {
             // Mono buffer to multi-channel output (upmix)
             for (int frame = 0; frame < frames_to_copy; ++frame) {
-                float sample = state->buffer_data[state->current_frame + frame];
+                float sample = state->buffer_data[current_frame + frame];
 
 #ifdef __wasm_simd128__
                 if (state->channels >= 4) {
@@ -227,7 +340,7 @@ void processBufferSourceNode(
                 // Copy available channels
                 for (int ch = 0; ch < min_channels; ++ch) {
                     output[(frames_written + frame) * state->channels + ch] =
-                        state->buffer_data[(state->current_frame + frame) * state->buffer_channels + ch];
+                        state->buffer_data[(current_frame + frame) * state->buffer_channels + ch];
                 }
 
                 // Zero remaining channels if output has more channels
@@ -238,7 +351,264 @@ void processBufferSourceNode(
         }
 
         frames_written += frames_to_copy;
-        state->current_frame += frames_to_copy;
+        current_frame += frames_to_copy;
+    }
+    state->position = current_frame;
+}
+
+// Loop region in buffer frames: loopStart/loopEnd when they make a valid
+// region, else the whole buffer (as in the Web Audio API)
+static void loopRegion(const BufferSourceNodeState* state, double& start, double& end) {
+    start = 0.0;
+    end = state->buffer_frames;
+    if (state->loop_start >= 0.0 && state->loop_end > 0.0 && state->loop_start < state->loop_end) {
+        start = std::min(state->loop_start * state->sample_rate, end);
+        end = std::min(state->loop_end * state->sample_rate, end);
+        if (start >= end) start = 0.0;
+    }
+}
+
+// Read positions of the next `count` output frames at the given rates (buffer
+// frames per output frame), advancing the playhead: whole[i] is the frame
+// before the position, frac[i] the fraction past it. Returns how many frames
+// play before the playhead runs off the buffer (all of them when looping).
+static int advancePlayhead(BufferSourceNodeState* state, const float* rate, int count, int* whole, float* frac) {
+    double loop_start, loop_end;
+    loopRegion(state, loop_start, loop_end);
+    const double loop_length = loop_end - loop_start;
+    const double end = state->buffer_frames;
+
+    double position = state->position;
+    int i = 0;
+    for (; i < count; ++i) {
+        if (state->loop && loop_length > 0.0) {
+            if (position >= loop_end) {
+                position = loop_start + std::fmod(position - loop_start, loop_length);
+            } else if (position < loop_start && rate[i] < 0.0f) {
+                position = loop_end - std::fmod(loop_start - position, loop_length);
+            }
+        } else if (position >= end || position < 0.0) {
+            break;
+        }
+        const double floor_position = std::floor(position);
+        whole[i] = static_cast<int>(floor_position);
+        frac[i] = static_cast<float>(position - floor_position);
+        position += rate[i];
+    }
+    state->position = position;
+    return i;
+}
+
+// Buffer frame a tap reads, or -1 for silence. Inside a loop the frames past
+// either end of the loop are those at its other end; outside the buffer there
+// is nothing to read.
+static inline int tapFrame(const BufferSourceNodeState* state, bool looping, int loop_start, int loop_end, int frame) {
+    if (looping) {
+        const int length = loop_end - loop_start;
+        while (frame >= loop_end) frame -= length;
+        while (frame < loop_start) frame += length;
+        return frame;
+    }
+    return (frame >= 0 && frame < state->buffer_frames) ? frame : -1;
+}
+
+// Interpolate buffer channel `channel` at the read positions into `out`.
+// Four output frames at a time: their taps are gathered lane by lane (from the
+// buffer directly, or through tapFrame into a small window near the buffer
+// and loop edges), then weighted and summed in SIMD.
+static void interpolateChannel(const BufferSourceNodeState* state, int channel, const int* whole,
+                               const float* frac, int count, float* out) {
+    const Interpolation mode = state->interpolation;
+    const int before = tapsBefore(mode);
+    const int taps = tapCount(mode);
+    const int stride = state->buffer_channels;
+    const float* data = state->buffer_data + channel;
+    const float* sinc = mode == Interpolation::SINC ? sincTable() : nullptr;
+
+    int loop_start = 0, loop_end = state->buffer_frames;
+    if (state->loop) {
+        double start, end;
+        loopRegion(state, start, end);
+        loop_start = static_cast<int>(start);
+        loop_end = std::max(loop_start + 1, static_cast<int>(std::ceil(end)));
+    }
+
+    float window[4][SINC_TAPS];
+    for (int i = 0; i < count; i += 4) {
+        const int lanes = std::min(4, count - i);
+        const float* base[4];
+        int step[4];
+        const float* row[4];
+        float f[4];
+        for (int k = 0; k < 4; ++k) {
+            const int n = i + std::min(k, lanes - 1);
+            f[k] = frac[n];
+            row[k] = sinc ? sinc + static_cast<int>(frac[n] * SINC_PHASES + 0.5f) * SINC_TAPS : nullptr;
+            const int first = whole[n] - before;
+            const bool looping = state->loop && whole[n] >= loop_start;
+            const int lo = looping ? loop_start : 0;
+            const int hi = looping ? loop_end : state->buffer_frames;
+            if (first >= lo && first + taps <= hi) {
+                base[k] = data + first * stride;
+                step[k] = stride;
+                continue;
+            }
+            for (int t = 0; t < taps; ++t) {
+                const int frame = tapFrame(state, looping, loop_start, loop_end, first + t);
+                window[k][t] = frame >= 0 ? data[frame * stride] : 0.0f;
+            }
+            base[k] = window[k];
+            step[k] = 1;
+        }
+
+        float result[4];
+#ifdef __wasm_simd128__
+        auto tap = [&](int t) {
+            return wasm_f32x4_make(base[0][t * step[0]], base[1][t * step[1]], base[2][t * step[2]],
+                                   base[3][t * step[3]]);
+        };
+        const v128_t x = wasm_v128_load(f);
+        v128_t sum;
+        if (mode == Interpolation::LINEAR) {
+            const v128_t a = tap(0);
+            sum = wasm_f32x4_add(a, wasm_f32x4_mul(wasm_f32x4_sub(tap(1), a), x));
+        } else if (mode == Interpolation::CUBIC) {
+            const v128_t y0 = tap(0), y1 = tap(1), y2 = tap(2), y3 = tap(3);
+            const v128_t half = wasm_f32x4_splat(0.5f);
+            const v128_t c1 = wasm_f32x4_mul(half, wasm_f32x4_sub(y2, y0));
+            const v128_t c2 = wasm_f32x4_sub(
+                wasm_f32x4_add(y0, wasm_f32x4_mul(wasm_f32x4_splat(2.0f), y2)),
+                wasm_f32x4_add(wasm_f32x4_mul(wasm_f32x4_splat(2.5f), y1), wasm_f32x4_mul(half, y3)));
+            const v128_t c3 = wasm_f32x4_add(wasm_f32x4_mul(half, wasm_f32x4_sub(y3, y0)),
+                                             wasm_f32x4_mul(wasm_f32x4_splat(1.5f), wasm_f32x4_sub(y1, y2)));
+            sum = wasm_f32x4_add(wasm_f32x4_mul(wasm_f32x4_add(wasm_f32x4_mul(wasm_f32x4_add(
+                      wasm_f32x4_mul(c3, x), c2), x), c1), x), y1);
+        } else {
+            sum = wasm_f32x4_splat(0.0f);
+            for (int t = 0; t < SINC_TAPS; ++t) {
+                const v128_t weight = wasm_f32x4_make(row[0][t], row[1][t], row[2][t], row[3][t]);
+                sum = wasm_f32x4_add(sum, wasm_f32x4_mul(tap(t), weight));
+            }
+        }
+        wasm_v128_store(result, sum);
+#else
+        for (int k = 0; k < 4; ++k) {
+            auto tap = [&](int t) { return base[k][t * step[k]]; };
+            const float x = f[k];
+            if (mode == Interpolation::LINEAR) {
+                result[k] = tap(0) + (tap(1) - tap(0)) * x;
+            } else if (mode == Interpolation::CUBIC) {
+                const float y0 = tap(0), y1 = tap(1), y2 = tap(2), y3 = tap(3);
+                const float c1 = 0.5f * (y2 - y0);
+                const float c2 = y0 + 2.0f * y2 - 2.5f * y1 - 0.5f * y3;
+                const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+                result[k] = ((c3 * x + c2) * x + c1) * x + y1;
+            } else {
+                float sum = 0.0f;
+                for (int t = 0; t < SINC_TAPS; ++t) sum += tap(t) * row[k][t];
+                result[k] = sum;
+            }
+        }
+#endif
+        for (int k = 0; k < lanes; ++k) out[i + k] = result[k];
+    }
+}
+
+// Resampled playback of up to RESAMPLE_CHUNK frames at per-frame rates:
+// positions first, then each buffer channel interpolated once and written to
+// the output channels it feeds (a mono buffer to all of them). Frames after
+// the end of the buffer are silent.
+static void resampleFrames(BufferSourceNodeState* state, float* output, int frame_count, const float* rate) {
+    const int channels = state->channels;
+    int whole[RESAMPLE_CHUNK];
+    float frac[RESAMPLE_CHUNK];
+    float rendered[RESAMPLE_CHUNK];
+
+    const int playing = state->is_active ? advancePlayhead(state, rate, frame_count, whole, frac) : 0;
+    for (int ch = 0; ch < channels; ++ch) {
+        const int source = state->buffer_channels == 1 ? 0 : ch;
+        if (source >= state->buffer_channels) {
+            for (int i = 0; i < playing; ++i) output[i * channels + ch] = 0.0f;
+        } else if (source != ch) {
+            for (int i = 0; i < playing; ++i) output[i * channels + ch] = output[i * channels];
+        } else {
+            interpolateChannel(state, source, whole, frac, playing, rendered);
+            for (int i = 0; i < playing; ++i) output[i * channels + ch] = rendered[i];
+        }
+    }
+
+    if (playing < frame_count) {
+        memset(output + playing * channels, 0, (frame_count - playing) * channels * sizeof(float));
+        state->is_active = false;
+    }
+}
+
+// Rate of buffer frames per output frame: playbackRate * 2^(detune / 1200)
+static inline float computedPlaybackRate(float playback_rate, float detune) {
+    float rate = playback_rate;
+    if (detune != 0.0f) rate *= std::pow(2.0f, detune / 1200.0f);
+    return std::isfinite(rate) ? rate : 0.0f;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void processBufferSourceNode(
+    BufferSourceNodeState* state,
+    float* output,
+    int frame_count,
+    float playback_rate,
+    float detune
+) {
+    if (!state) return;
+
+    const int output_samples = frame_count * state->channels;
+
+    // If not active or no buffer, output silence
+    if (!state->is_active || !state->buffer_data || state->buffer_frames == 0) {
+        memset(output, 0, output_samples * sizeof(float));
+        return;
+    }
+
+    const float rate = computedPlaybackRate(playback_rate, detune);
+
+    // Straight copy when nothing needs resampling
+    double loop_start, loop_end;
+    loopRegion(state, loop_start, loop_end);
+    const bool whole_loop = !state->loop || (loop_start == 0.0 && loop_end == state->buffer_frames);
+    if (rate == 1.0f && whole_loop && state->position == std::floor(state->position) && state->position >= 0.0) {
+        copyFrames(state, output, frame_count);
+        return;
+    }
+
+    float rates[RESAMPLE_CHUNK];
+    std::fill(rates, rates + RESAMPLE_CHUNK, rate);
+    for (int done = 0; done < frame_count; done += RESAMPLE_CHUNK) {
+        const int chunk = std::min(RESAMPLE_CHUNK, frame_count - done);
+        resampleFrames(state, output + done * state->channels, chunk, rates);
+    }
+}
+
+// Buffer source with audio-rate playbackRate and detune: the playhead advances
+// by each frame's own rate (vibrato, pitch sweeps, scratching).
+EMSCRIPTEN_KEEPALIVE
+void processBufferSourceNodeARate(
+    BufferSourceNodeState* state,
+    float* output,
+    int frame_count,
+    const float* playback_rate,
+    const float* detune
+) {
+    if (!state) return;
+
+    if (!state->is_active || !state->buffer_data || state->buffer_frames == 0) {
+        memset(output, 0, frame_count * state->channels * sizeof(float));
+        return;
+    }
+
+    float rates[RESAMPLE_CHUNK];
+    for (int done = 0; done < frame_count; done += RESAMPLE_CHUNK) {
+        const int chunk = std::min(RESAMPLE_CHUNK, frame_count - done);
+        for (int i = 0; i < chunk; ++i) rates[i] = computedPlaybackRate(playback_rate[done + i], detune[done + i]);
+        resampleFrames(state, output + done * state->channels, chunk, rates);
     }
 }
 
@@ -37,6 +37,11 @@ void stopConstantSource(ConstantSourceNodeState* state) {
     if (state) state->is_playing = false;
 }
 
+EMSCRIPTEN_KEEPALIVE
+bool isConstantSourcePlaying(ConstantSourceNodeState* state) {
+    return state && state->is_playing;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void setConstantSourceOffset(ConstantSourceNodeState* state, float offset) {
     if (state) state->offset = offset;
@@ -60,4 +65,22 @@ void processConstantSourceNode(
     }
 }
 
+// Constant source with an audio-rate offset param: one offset value per frame.
+EMSCRIPTEN_KEEPALIVE
+void processConstantSourceNodeARate(
+    ConstantSourceNodeState* state,
+    float* output,
+    int frame_count,
+    const float* offset
+) {
+    if (!state) return;
+
+    const int channels = state->channels;
+    for (int i = 0; i < frame_count; i++) {
+        for (int ch = 0; ch < channels; ch++) {
+            output[i * channels + ch] = offset[i];
+        }
+    }
+}
+
 } // extern "C"
@@ -23,8 +23,7 @@ struct ConvolverNodeState {
     int channels;
     bool normalize;
 
-    // Impulse response
-    float** ir_buffers;  // Per channel
+    // Impulse response length; the response itself is only kept as ir_fft
     int ir_length;
 
     // FFT buffers for overlap-add
@@ -52,7 +51,6 @@ ConvolverNodeState* createConvolverNode(int sample_rate, int channels) {
     state->sample_rate = sample_rate;
     state->channels = channels;
     state->normalize = true;
-    state->ir_buffers = nullptr;
     state->ir_length = 0;
     state->ir_fft = nullptr;
     state->fft_buffer = nullptr;
@@ -68,13 +66,6 @@ EMSCRIPTEN_KEEPALIVE
 void destroyConvolverNode(ConvolverNodeState* state) {
     if (!state) return;
 
-    if (state->ir_buffers) {
-        for (int ch = 0; ch < state->channels; ch++) {
-            delete[] state->ir_buffers[ch];
-        }
-        delete[] state->ir_buffers;
-    }
-
     if (state->ir_fft) {
         for (int ch = 0; ch < state->channels; ch++) {
             delete[] state->ir_fft[ch];
@@ -106,20 +97,21 @@ void destroyConvolverNode(ConvolverNodeState* state) {
     delete state;
 }
 
+// Impulse response from `buffer_data` (interleaved frames), which is only read
+// during the call: the graph's sample store holds the PCM, the node keeps its
+// spectrum.
 EMSCRIPTEN_KEEPALIVE
-void setConvolverBuffer(ConvolverNodeState* state, float* buffer_data, int length, int num_channels) {
+void setConvolverBuffer(ConvolverNodeState* state, const float* buffer_data, int length, int num_channels) {
     if (!state) return;
 
     // Clean up old buffers
-    if (state->ir_buffers) {
+    if (state->ir_fft) {
         for (int ch = 0; ch < state->channels; ch++) {
-            delete[] state->ir_buffers[ch];
             delete[] state->ir_fft[ch];
             delete[] state->fft_buffer[ch];
             delete[] state->overlap_buffer[ch];
             delete[] state->input_buffer[ch];
         }
-        delete[] state->ir_buffers;
         delete[] state->ir_fft;
         delete[] state->fft_buffer;
         delete[] state->overlap_buffer;
@@ -131,7 +123,6 @@ void setConvolverBuffer(ConvolverNodeState* state, float* buffer_data, int lengt
     state->fft_size = nextPowerOf2(state->block_size + length - 1);
 
     // Allocate new buffers
-    state->ir_buffers = new float*[state->channels];
     state->ir_fft = new Complex*[state->channels];
     state->fft_buffer = new Complex*[state->channels];
     state->overlap_buffer = new float*[state->channels];
@@ -151,21 +142,16 @@ void setConvolverBuffer(ConvolverNodeState* state, float* buffer_data, int lengt
 
     // De-interleave and prepare impulse response
     for (int ch = 0; ch < state->channels; ch++) {
-        state->ir_buffers[ch] = new float[length];
         state->ir_fft[ch] = new Complex[state->fft_size];
         state->fft_buffer[ch] = new Complex[state->fft_size];
         state->overlap_buffer[ch] = new float[state->fft_size]();
         state->input_buffer[ch] = new float[state->block_size](); // Now sized to match IR
 
-        // Copy and normalize IR
+        // De-interleave and normalize the IR straight into the FFT input, then
+        // pre-compute its spectrum
         int src_channel = (ch < num_channels) ? ch : 0;
         for (int i = 0; i < length; i++) {
-            state->ir_buffers[ch][i] = buffer_data[i * num_channels + src_channel] * norm_factor;
-        }
-
-        // Pre-compute FFT of impulse response (not used in direct convolution, but keep for compatibility)
-        for (int i = 0; i < length; i++) {
-            state->ir_fft[ch][i].real = state->ir_buffers[ch][i];
+            state->ir_fft[ch][i].real = buffer_data[i * num_channels + src_channel] * norm_factor;
             state->ir_fft[ch][i].imag = 0.0f;
         }
         for (int i = length; i < state->fft_size; i++) {
@@ -183,6 +169,14 @@ void setConvolverNormalize(ConvolverNodeState* state, bool normalize) {
     if (state) state->normalize = normalize;
 }
 
+// Frames of output after the input goes silent: the impulse response itself,
+// plus the partly filled input block and the overlap still to be added.
+EMSCRIPTEN_KEEPALIVE
+int getConvolverTailFrames(ConvolverNodeState* state) {
+    if (!state || !state->ir_fft) return 0;
+    return state->ir_length + state->block_size + state->fft_size;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void processConvolverNode(
     ConvolverNodeState* state,
@@ -191,7 +185,7 @@ void processConvolverNode(
     int frame_count,
     bool has_input
 ) {
-    if (!state || !state->ir_buffers || !has_input) {
+    if (!state || !state->ir_fft || !has_input) {
         memset(output, 0, frame_count * state->channels * sizeof(float));
         return;
     }
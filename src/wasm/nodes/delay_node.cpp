@@ -55,6 +55,15 @@ void setDelayTime(DelayNodeState* state, float delay_time) {
     state->current_delay_time = fminf(delay_time, state->max_delay_time);
 }
 
+// Frames until everything written into the delay line has been read back out.
+// Uses the maximum delay rather than the current one: the delay time can be
+// raised later and would then read further back into the buffer.
+EMSCRIPTEN_KEEPALIVE
+int getDelayTailFrames(DelayNodeState* state) {
+    if (!state) return 0;
+    return static_cast<int>(ceilf(state->max_delay_time * state->sample_rate)) + 1;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void processDelayNode(
     DelayNodeState* state,
@@ -101,4 +110,38 @@ void processDelayNode(
     }
 }
 
+// Delay with an audio-rate delay time (chorus, flanger, vibrato): each frame
+// reads back its own distance, clamped to [0, max delay].
+EMSCRIPTEN_KEEPALIVE
+void processDelayNodeARate(
+    DelayNodeState* state,
+    float* input,
+    float* output,
+    int frame_count,
+    const float* delay_time
+) {
+    if (!state) return;
+
+    const int buffer_length = state->buffer_length;
+    for (int i = 0; i < frame_count; i++) {
+        const float delay = fminf(fmaxf(delay_time[i], 0.0f), state->max_delay_time);
+        const float read_position = state->write_index - delay * state->sample_rate;
+        const int read_index1 = static_cast<int>(floorf(read_position));
+        const float frac = read_position - read_index1;
+        const int wrapped_index1 = (read_index1 + buffer_length) % buffer_length;
+        const int wrapped_index2 = (wrapped_index1 + 1) % buffer_length;
+
+        for (int ch = 0; ch < state->channels; ch++) {
+            const int idx = i * state->channels + ch;
+            float* line = state->delay_buffers[ch];
+            line[state->write_index] = input[idx];
+            const float sample1 = line[wrapped_index1];
+            const float sample2 = line[wrapped_index2];
+            output[idx] = sample1 + frac * (sample2 - sample1);
+        }
+
+        state->write_index = (state->write_index + 1) % buffer_length;
+    }
+}
+
 } // extern "C"
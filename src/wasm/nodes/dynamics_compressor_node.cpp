@@ -106,6 +106,17 @@ static float computeGainReduction(float input_db, float threshold, float knee, f
     }
 }
 
+// The output is input times gain, so it is silent as soon as the input is; what
+// still runs on is the envelope, relaxing back towards no gain reduction. Keep
+// processing until it has released from up to ~80 dB of reduction to below
+// 0.01 dB (ln(8000) ~ 9 release time constants), so the next sound isn't
+// squashed by a stale envelope.
+EMSCRIPTEN_KEEPALIVE
+int getDynamicsCompressorTailFrames(DynamicsCompressorNodeState* state) {
+    if (!state) return 0;
+    return static_cast<int>(ceilf(state->release * state->sample_rate * 9.0f));
+}
+
 EMSCRIPTEN_KEEPALIVE
 void processDynamicsCompressorNode(
     DynamicsCompressorNodeState* state,
@@ -100,4 +100,30 @@ void processGainNode(
     ApplyGain(output, sample_count, gain);
 }
 
+// Gain with an audio-rate gain param: one gain value per frame.
+EMSCRIPTEN_KEEPALIVE
+void processGainNodeARate(
+    GainNodeState* state,
+    float* input,
+    float* output,
+    int frame_count,
+    const float* gain
+) {
+    if (!state) return;
+
+    const int channels = state->channels;
+    if (channels == 2) {
+        for (int i = 0; i < frame_count; ++i) {
+            output[i * 2] = input[i * 2] * gain[i];
+            output[i * 2 + 1] = input[i * 2 + 1] * gain[i];
+        }
+        return;
+    }
+    for (int i = 0; i < frame_count; ++i) {
+        for (int ch = 0; ch < channels; ++ch) {
+            output[i * channels + ch] = input[i * channels + ch] * gain[i];
+        }
+    }
+}
+
 } // extern "C"
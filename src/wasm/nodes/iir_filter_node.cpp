@@ -19,8 +19,44 @@ struct IIRFilterNodeState {
     float** x_history;
     float** y_history;
     int history_index;
+
+    // Frames the filter rings for after its input goes silent (-1: never settles)
+    int tail_frames;
 };
 
+// Measure the ring-out by running an impulse through the feedback section until
+// the response stays below -120 dB for a full window. Done once per coefficient
+// set; an arbitrary-order denominator has no closed form worth solving here.
+// Responses still above the threshold after 10 seconds count as never settling.
+static int measureTailFrames(const float* feedback, int feedback_length, int feedforward_length, int sample_rate) {
+    if (feedback_length <= 1) return feedforward_length;
+
+    const int max_frames = sample_rate * 10;
+    const int window = feedback_length > 64 ? feedback_length : 64;
+    float* y = new float[feedback_length]();  // y[n-1] .. y[n-order], newest first
+    int quiet = 0;
+    int tail = -1;
+
+    for (int n = 0; n < max_frames; n++) {
+        float out = (n == 0) ? 1.0f : 0.0f;
+        for (int k = 1; k < feedback_length; k++) {
+            out -= feedback[k] * y[k - 1];
+        }
+        memmove(y + 1, y, (feedback_length - 1) * sizeof(float));
+        y[0] = out;
+
+        if (!std::isfinite(out)) break;
+        quiet = fabsf(out) < 1e-6f ? quiet + 1 : 0;
+        if (quiet >= window) {
+            tail = n - window + 1 + feedforward_length;
+            break;
+        }
+    }
+
+    delete[] y;
+    return tail;
+}
+
 extern "C" {
 
 EMSCRIPTEN_KEEPALIVE
@@ -68,6 +104,7 @@ IIRFilterNodeState* createIIRFilterNode(
     }
 
     state->history_index = 0;
+    state->tail_frames = measureTailFrames(state->feedback, feedback_length, feedforward_length, sample_rate);
 
     return state;
 }
@@ -91,6 +128,11 @@ void destroyIIRFilterNode(IIRFilterNodeState* state) {
     delete state;
 }
 
+EMSCRIPTEN_KEEPALIVE
+int getIIRFilterTailFrames(IIRFilterNodeState* state) {
+    return state ? state->tail_frames : 0;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void processIIRFilterNode(
     IIRFilterNodeState* state,
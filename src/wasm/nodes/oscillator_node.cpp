@@ -1,16 +1,201 @@
 // OscillatorNode WASM implementation
-// Generates periodic waveforms: sine, square, sawtooth, triangle
+// Generates periodic waveforms: sine, square, sawtooth, triangle, custom
+// (PeriodicWave), all played from band-limited wavetables
 
 #include <emscripten.h>
 #include <wasm_simd128.h>
 #include <cmath>
 #include <cstring>
 #include <cstdio>
+#include <algorithm>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+// Complex number layout for FFT (matches utils/fft.cpp)
+struct Complex {
+    float real;
+    float imag;
+};
+
+extern "C" void computeFFT(Complex* data, int n, bool inverse);
+
+// Band-limited wavetables
+//
+// A waveform is a set of tables, one per octave of playback frequency: level L
+// holds the harmonics up to WAVETABLE_MAX_HARMONICS >> L, and a fundamental of
+// f Hz plays from the richest level whose top harmonic stays below Nyquist, so
+// nothing aliases. Levels whose harmonic limit is above the waveform's own top
+// harmonic would all be the same table; only the first of them is stored.
+static const int WAVETABLE_SIZE = 4096;
+static const int WAVETABLE_MAX_HARMONICS = 1024;
+static const int WAVETABLE_LEVELS = 11;  // 1024, 512, ..., 1 harmonics
+
+struct WaveTableSet {
+    int first_level;  // level of tables[0]
+    int table_count;
+    float* tables;    // table_count tables of WAVETABLE_SIZE + 1 floats; the
+                      // extra one repeats the first, for interpolation
+};
+
+// Build the tables for Fourier coefficients real[k] cos + imag[k] sin of
+// harmonic k (k = 1 .. count - 1; index 0, the DC term, is ignored as in the
+// Web Audio API). With `normalize`, every level is scaled by the same factor so
+// the richest one peaks at 1 and switching levels doesn't change the volume.
+static WaveTableSet* createWaveTableSet(const float* real, const float* imag, int count, bool normalize) {
+    int top = 0;
+    for (int k = std::min(count, WAVETABLE_MAX_HARMONICS + 1) - 1; k > 0 && !top; --k) {
+        if (real[k] != 0.0f || imag[k] != 0.0f) top = k;
+    }
+
+    WaveTableSet* set = new WaveTableSet();
+    set->first_level = 0;
+    while (set->first_level + 1 < WAVETABLE_LEVELS && (WAVETABLE_MAX_HARMONICS >> (set->first_level + 1)) >= top) {
+        set->first_level++;
+    }
+    set->table_count = WAVETABLE_LEVELS - set->first_level;
+    set->tables = new float[set->table_count * (WAVETABLE_SIZE + 1)];
+
+    // Inverse FFT of the spectrum cut off at each level's harmonic limit.
+    // X[k] = N/2 (a - ib) and its mirror give a cos + b sin after the 1/N scaling.
+    Complex* spectrum = new Complex[WAVETABLE_SIZE];
+    const float half_size = WAVETABLE_SIZE * 0.5f;
+    for (int t = 0; t < set->table_count; ++t) {
+        const int limit = std::min(top, WAVETABLE_MAX_HARMONICS >> (set->first_level + t));
+        memset(spectrum, 0, WAVETABLE_SIZE * sizeof(Complex));
+        for (int k = 1; k <= limit; ++k) {
+            spectrum[k].real = half_size * real[k];
+            spectrum[k].imag = -half_size * imag[k];
+            spectrum[WAVETABLE_SIZE - k].real = spectrum[k].real;
+            spectrum[WAVETABLE_SIZE - k].imag = -spectrum[k].imag;
+        }
+        computeFFT(spectrum, WAVETABLE_SIZE, true);
+
+        float* table = set->tables + t * (WAVETABLE_SIZE + 1);
+        for (int i = 0; i < WAVETABLE_SIZE; ++i) table[i] = spectrum[i].real;
+        table[WAVETABLE_SIZE] = table[0];
+    }
+    delete[] spectrum;
+
+    if (normalize) {
+        float peak = 0.0f;
+        for (int i = 0; i < WAVETABLE_SIZE; ++i) peak = std::max(peak, std::fabs(set->tables[i]));
+        if (peak > 0.0f) {
+            const float scale = 1.0f / peak;
+            for (int i = 0; i < set->table_count * (WAVETABLE_SIZE + 1); ++i) set->tables[i] *= scale;
+        }
+    }
+    return set;
+}
+
+static void destroyWaveTableSet(WaveTableSet* set) {
+    if (!set) return;
+    delete[] set->tables;
+    delete set;
+}
+
+// Tables of the built-in types, from their Fourier series in the Web Audio
+// API spec. Built on first use and shared by every oscillator.
+static const WaveTableSet* builtinWaveTables(int wave_type) {
+    static WaveTableSet* sets[4] = {};
+    if (wave_type < 0 || wave_type > 3) return nullptr;
+    if (!sets[wave_type]) {
+        const int count = WAVETABLE_MAX_HARMONICS + 1;
+        float* real = new float[count]();
+        float* imag = new float[count]();
+        for (int k = 1; k < count; ++k) {
+            const double pik = M_PI * k;
+            switch (wave_type) {
+                case 0: imag[k] = k == 1 ? 1.0f : 0.0f; break;                          // sine
+                case 1: imag[k] = (k & 1) ? 4.0 / pik : 0.0; break;                   // square
+                case 2: imag[k] = ((k & 1) ? 2.0 : -2.0) / pik; break;                // sawtooth
+                case 3: imag[k] = 8.0 * std::sin(pik / 2.0) / (pik * pik); break;     // triangle
+            }
+        }
+        sets[wave_type] = createWaveTableSet(real, imag, count, wave_type != 0);
+        delete[] real;
+        delete[] imag;
+    }
+    return sets[wave_type];
+}
+
+// Table to play a fundamental of `frequency` Hz from: level L is the lowest
+// with (WAVETABLE_MAX_HARMONICS >> L) * frequency below Nyquist.
+static inline const float* selectWaveTable(const WaveTableSet* set, float frequency, float nyquist) {
+    const float ratio = WAVETABLE_MAX_HARMONICS * std::fabs(frequency) / nyquist;
+    int level = 0;
+    if (ratio >= 1.0f) std::frexp(ratio, &level);
+    level = std::min(std::max(level - set->first_level, 0), set->table_count - 1);
+    return set->tables + level * (WAVETABLE_SIZE + 1);
+}
+
+#ifdef __wasm_simd128__
+// Phases wrapped into [0, 1]
+static inline v128_t wrapPhase4(v128_t phase) {
+    return wasm_f32x4_sub(phase, wasm_f32x4_floor(phase));
+}
+
+// sin(2 pi phase) for four phases in [0, 1]: folded onto the quarter period
+// around zero, then the Taylor series to the 11th power (error below 1e-7
+// there). Cheaper than four table reads, which have to load lane by lane.
+static inline v128_t sine4(v128_t phase) {
+    const v128_t half = wasm_f32x4_splat(0.5f);
+    const v128_t quarter = wasm_f32x4_splat(0.25f);
+    const v128_t neg_quarter = wasm_f32x4_splat(-0.25f);
+
+    // sin(2 pi phase) = -sin(2 pi x) with x in [-0.5, 0.5], and
+    // sin(2 pi x) = sin(2 pi (+-0.5 - x)) brings x into [-0.25, 0.25]
+    v128_t x = wasm_f32x4_sub(phase, half);
+    x = wasm_v128_bitselect(wasm_f32x4_sub(half, x), x, wasm_f32x4_gt(x, quarter));
+    x = wasm_v128_bitselect(wasm_f32x4_sub(wasm_f32x4_neg(half), x), x, wasm_f32x4_lt(x, neg_quarter));
+
+    const v128_t t = wasm_f32x4_mul(x, wasm_f32x4_splat(static_cast<float>(2.0 * M_PI)));
+    const v128_t t2 = wasm_f32x4_mul(t, t);
+    v128_t poly = wasm_f32x4_splat(-1.0f / 39916800.0f);
+    poly = wasm_f32x4_add(wasm_f32x4_mul(poly, t2), wasm_f32x4_splat(1.0f / 362880.0f));
+    poly = wasm_f32x4_add(wasm_f32x4_mul(poly, t2), wasm_f32x4_splat(-1.0f / 5040.0f));
+    poly = wasm_f32x4_add(wasm_f32x4_mul(poly, t2), wasm_f32x4_splat(1.0f / 120.0f));
+    poly = wasm_f32x4_add(wasm_f32x4_mul(poly, t2), wasm_f32x4_splat(-1.0f / 6.0f));
+    poly = wasm_f32x4_add(wasm_f32x4_mul(poly, t2), wasm_f32x4_splat(1.0f));
+    return wasm_f32x4_neg(wasm_f32x4_mul(poly, t));
+}
+
+// Four interpolated reads of `table` at phases in [0, 1] (1 wraps to 0). There
+// is no gather: the points are loaded lane by lane, the rest is vector math.
+static inline v128_t readWaveTable4(const float* table, v128_t phase) {
+    const v128_t pos = wasm_f32x4_mul(phase, wasm_f32x4_splat(static_cast<float>(WAVETABLE_SIZE)));
+    const v128_t whole = wasm_i32x4_trunc_sat_f32x4(pos);
+    const v128_t frac = wasm_f32x4_sub(pos, wasm_f32x4_convert_i32x4(whole));
+    const v128_t index = wasm_v128_and(whole, wasm_i32x4_splat(WAVETABLE_SIZE - 1));
+    const int i0 = wasm_i32x4_extract_lane(index, 0);
+    const int i1 = wasm_i32x4_extract_lane(index, 1);
+    const int i2 = wasm_i32x4_extract_lane(index, 2);
+    const int i3 = wasm_i32x4_extract_lane(index, 3);
+    const v128_t a = wasm_f32x4_make(table[i0], table[i1], table[i2], table[i3]);
+    const v128_t b = wasm_f32x4_make(table[i0 + 1], table[i1 + 1], table[i2 + 1], table[i3 + 1]);
+    return wasm_f32x4_add(a, wasm_f32x4_mul(wasm_f32x4_sub(b, a), frac));
+}
+#endif
+
+// Four samples of a waveform at `phases` (in [0, 1]), read from `table`; a
+// sine is computed instead where SIMD is available.
+static inline void renderSamples4(bool sine, const float* table, const double phases[4], float* out) {
+#ifdef __wasm_simd128__
+    const v128_t phase = wasm_f32x4_make(static_cast<float>(phases[0]), static_cast<float>(phases[1]),
+                                         static_cast<float>(phases[2]), static_cast<float>(phases[3]));
+    wasm_v128_store(out, sine ? sine4(phase) : readWaveTable4(table, phase));
+#else
+    (void)sine;
+    for (int k = 0; k < 4; ++k) {
+        const double pos = phases[k] * WAVETABLE_SIZE;
+        const int whole = static_cast<int>(pos);
+        const int i = whole & (WAVETABLE_SIZE - 1);
+        out[k] = table[i] + (table[i + 1] - table[i]) * static_cast<float>(pos - whole);
+    }
+#endif
+}
+
 // Wave types
 enum class WaveType {
     SINE = 0,
@@ -30,9 +215,8 @@ struct OscillatorNodeState {
 
     double phase;
 
-    // Custom wavetable
-    float* custom_wavetable;
-    int wavetable_size;
+    // Band-limited tables of a custom PeriodicWave (not owned)
+    const WaveTableSet* custom_tables;
 
     // Scheduled timing
     double scheduled_start_time;
@@ -56,8 +240,7 @@ OscillatorNodeState* createOscillatorNode(
     state->is_active = false;  // Oscillator starts stopped
     state->wave_type = static_cast<WaveType>(wave_type_int);
     state->phase = 0.0;
-    state->custom_wavetable = nullptr;
-    state->wavetable_size = 0;
+    state->custom_tables = nullptr;
     state->scheduled_start_time = -1.0;
     state->scheduled_stop_time = -1.0;
     state->current_time = 0.0;
@@ -69,11 +252,6 @@ OscillatorNodeState* createOscillatorNode(
 EMSCRIPTEN_KEEPALIVE
 void destroyOscillatorNode(OscillatorNodeState* state) {
     if (!state) return;
-
-    if (state->custom_wavetable) {
-        delete[] state->custom_wavetable;
-    }
-
     delete state;
 }
 
@@ -100,22 +278,33 @@ void setOscillatorWaveType(OscillatorNodeState* state, int wave_type_int) {
     state->wave_type = static_cast<WaveType>(wave_type_int);
 }
 
+// Band-limited tables for PeriodicWave coefficients, synthesized level by
+// level with an inverse FFT. The graph keeps one set per distinct wave and
+// shares it between all oscillators playing it.
 EMSCRIPTEN_KEEPALIVE
-void setPeriodicWave(OscillatorNodeState* state, float* wavetable, int size) {
-    if (!state) return;
+WaveTableSet* createPeriodicWaveTables(const float* real, const float* imag, int count, bool normalize) {
+    if (!real || !imag || count < 2) return nullptr;
+    return createWaveTableSet(real, imag, count, normalize);
+}
 
-    // Free old wavetable
-    if (state->custom_wavetable) {
-        delete[] state->custom_wavetable;
-    }
+EMSCRIPTEN_KEEPALIVE
+void destroyPeriodicWaveTables(WaveTableSet* set) {
+    destroyWaveTableSet(set);
+}
 
-    // Allocate and copy new wavetable
-    state->custom_wavetable = new float[size];
-    memcpy(state->custom_wavetable, wavetable, size * sizeof(float));
-    state->wavetable_size = size;
+// Play a custom waveform from `tables`, which stay owned by the caller
+EMSCRIPTEN_KEEPALIVE
+void setOscillatorWaveTables(OscillatorNodeState* state, const WaveTableSet* tables) {
+    if (!state || !tables) return;
+    state->custom_tables = tables;
     state->wave_type = WaveType::CUSTOM;
 }
 
+EMSCRIPTEN_KEEPALIVE
+const WaveTableSet* getOscillatorWaveTables(OscillatorNodeState* state) {
+    return state ? state->custom_tables : nullptr;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void setOscillatorCurrentTime(OscillatorNodeState* state, double time) {
     if (!state) return;
@@ -134,47 +323,84 @@ void setOscillatorCurrentTime(OscillatorNodeState* state, double time) {
     }
 }
 
-// Generate single sample based on wave type
-static inline float GenerateSample(OscillatorNodeState* state) {
-    float sample = 0.0f;
-    double phase = state->phase;
+// Whether the oscillator is producing sound this quantum (started and not yet
+// stopped, as of the last setOscillatorCurrentTime). The graph skips inactive
+// oscillators instead of having them write a buffer of zeros.
+EMSCRIPTEN_KEEPALIVE
+bool isOscillatorActive(OscillatorNodeState* state) {
+    return state && state->is_active;
+}
 
-    switch (state->wave_type) {
-        case WaveType::SINE:
-            sample = std::sin(2.0 * M_PI * phase);
-            break;
+// True once the oscillator can't produce sound any more: its stop time has
+// passed, or it was never scheduled to start. The graph uses this to reclaim
+// oscillators JS has let go of.
+EMSCRIPTEN_KEEPALIVE
+bool isOscillatorFinished(OscillatorNodeState* state, double time) {
+    if (!state || state->scheduled_start_time < 0.0) return true;
+    if (state->has_stopped) return true;
+    return state->scheduled_stop_time >= 0.0 &&
+           time >= state->scheduled_stop_time &&
+           time >= state->scheduled_start_time;
+}
 
-        case WaveType::SQUARE:
-            sample = (phase < 0.5) ? 1.0f : -1.0f;
-            break;
+// Return a finished oscillator to its just-created state so the graph can hand
+// it out again instead of allocating a new one.
+EMSCRIPTEN_KEEPALIVE
+void resetOscillatorNode(OscillatorNodeState* state) {
+    if (!state) return;
 
-        case WaveType::SAWTOOTH:
-            sample = 2.0f * phase - 1.0f;
-            break;
+    state->custom_tables = nullptr;
+    state->is_active = false;
+    state->wave_type = WaveType::SINE;
+    state->phase = 0.0;
+    state->scheduled_start_time = -1.0;
+    state->scheduled_stop_time = -1.0;
+    state->current_time = 0.0;
+    state->has_started = false;
+    state->has_stopped = false;
+}
 
-        case WaveType::TRIANGLE:
-            if (phase < 0.5) {
-                sample = 4.0f * phase - 1.0f;
-            } else {
-                sample = -4.0f * phase + 3.0f;
-            }
-            break;
-
-        case WaveType::CUSTOM:
-            if (state->custom_wavetable && state->wavetable_size > 0) {
-                // Linear interpolation from wavetable
-                double index = phase * state->wavetable_size;
-                int i0 = static_cast<int>(index) % state->wavetable_size;
-                int i1 = (i0 + 1) % state->wavetable_size;
-                float frac = index - std::floor(index);
-                sample = state->custom_wavetable[i0] * (1.0f - frac) +
-                         state->custom_wavetable[i1] * frac;
-            }
-            break;
+// Tables the oscillator plays, or nullptr for a custom type without a wave
+static inline const WaveTableSet* waveTables(const OscillatorNodeState* state) {
+    if (state->wave_type == WaveType::CUSTOM) return state->custom_tables;
+    return builtinWaveTables(static_cast<int>(state->wave_type));
+}
+
+// Copy mono samples to every channel of frames frame .. frame + count - 1
+static inline void writeFrames(float* output, int channels, int frame, const float* samples, int count) {
+    for (int k = 0; k < count; ++k) {
+        float* out = output + (frame + k) * channels;
+#ifdef __wasm_simd128__
+        // SIMD-optimized channel duplication for 4+ channels
+        if (channels >= 4) {
+            const v128_t sample_vec = wasm_f32x4_splat(samples[k]);
+            int ch = 0;
+            for (; ch + 4 <= channels; ch += 4) wasm_v128_store(out + ch, sample_vec);
+            for (; ch < channels; ++ch) out[ch] = samples[k];
+            continue;
+        }
+#endif
+        for (int ch = 0; ch < channels; ++ch) out[ch] = samples[k];
     }
+}
 
-    return sample;
+#ifdef __wasm_simd128__
+// Four mono samples as four frames: mono output stores them as they are,
+// stereo interleaves each with itself, wider layouts copy per channel.
+static inline void storeFrames4(float* output, int channels, int frame, v128_t samples) {
+    float* out = output + frame * channels;
+    if (channels == 1) {
+        wasm_v128_store(out, samples);
+    } else if (channels == 2) {
+        wasm_v128_store(out, wasm_i32x4_shuffle(samples, samples, 0, 0, 1, 1));
+        wasm_v128_store(out + 4, wasm_i32x4_shuffle(samples, samples, 2, 2, 3, 3));
+    } else {
+        float mono[4];
+        wasm_v128_store(mono, samples);
+        writeFrames(output, channels, frame, mono, 4);
+    }
 }
+#endif
 
 EMSCRIPTEN_KEEPALIVE
 void processOscillatorNode(
@@ -187,7 +413,8 @@ void processOscillatorNode(
     if (!state) return;
 
     // If not active, output silence
-    if (!state->is_active) {
+    const WaveTableSet* set = waveTables(state);
+    if (!state->is_active || !set) {
         memset(output, 0, frame_count * state->channels * sizeof(float));
         return;
     }
@@ -196,76 +423,92 @@ void processOscillatorNode(
     float detune_multiplier = std::pow(2.0f, detune / 1200.0f);
     float actual_frequency = frequency * detune_multiplier;
 
-    double phase_increment = actual_frequency / static_cast<double>(state->sample_rate);
-
-    // Optimized path for sawtooth (most common, simple math)
-    if (state->wave_type == WaveType::SAWTOOTH) {
-        for (int frame = 0; frame < frame_count; ++frame) {
-            float sample = 2.0f * state->phase - 1.0f;
+    if (!std::isfinite(actual_frequency)) actual_frequency = 0.0f;
+    const double phase_increment = actual_frequency / static_cast<double>(state->sample_rate);
+    const float* table = selectWaveTable(set, actual_frequency, state->sample_rate * 0.5f);
+    const bool sine = state->wave_type == WaveType::SINE;
 
+    int frame = 0;
 #ifdef __wasm_simd128__
-            // SIMD-optimized channel duplication for 4+ channels
-            if (state->channels >= 4) {
-                v128_t sample_vec = wasm_f32x4_splat(sample);
-                int ch = 0;
-
-                // Write 4 channels at a time
-                for (; ch + 4 <= state->channels; ch += 4) {
-                    wasm_v128_store(&output[frame * state->channels + ch], sample_vec);
-                }
-
-                // Handle remaining channels
-                for (; ch < state->channels; ++ch) {
-                    output[frame * state->channels + ch] = sample;
-                }
-            } else
+    // Four consecutive frames per vector: the lanes start one increment apart
+    // and all advance by four. Float phases only have to hold up for one
+    // quantum; the double phase is advanced exactly at the end.
+    const float increment = static_cast<float>(phase_increment);
+    v128_t phase = wrapPhase4(wasm_f32x4_add(
+        wasm_f32x4_splat(static_cast<float>(state->phase)),
+        wasm_f32x4_mul(wasm_f32x4_make(0.0f, 1.0f, 2.0f, 3.0f), wasm_f32x4_splat(increment))));
+    const v128_t step = wasm_f32x4_splat(4.0f * increment);
+    for (; frame + 4 <= frame_count; frame += 4) {
+        storeFrames4(output, state->channels, frame, sine ? sine4(phase) : readWaveTable4(table, phase));
+        phase = wrapPhase4(wasm_f32x4_add(phase, step));
+    }
 #endif
-            {
-                // Scalar fallback for < 4 channels
-                for (int ch = 0; ch < state->channels; ++ch) {
-                    output[frame * state->channels + ch] = sample;
-                }
-            }
 
-            // Update phase
-            state->phase += phase_increment;
-            if (state->phase >= 1.0) {
-                state->phase -= 1.0;
-            }
+    // The remaining frames (all of them without SIMD)
+    for (; frame < frame_count; frame += 4) {
+        double phases[4];
+        for (int k = 0; k < 4; ++k) {
+            phases[k] = state->phase + (frame + k) * phase_increment;
+            phases[k] -= std::floor(phases[k]);
         }
-    } else {
-        // General path for other wave types
-        for (int frame = 0; frame < frame_count; ++frame) {
-            float sample = GenerateSample(state);
+        float samples[4];
+        renderSamples4(sine, table, phases, samples);
+        writeFrames(output, state->channels, frame, samples, std::min(4, frame_count - frame));
+    }
 
-#ifdef __wasm_simd128__
-            // SIMD-optimized channel duplication
-            if (state->channels >= 4) {
-                v128_t sample_vec = wasm_f32x4_splat(sample);
-                int ch = 0;
-
-                for (; ch + 4 <= state->channels; ch += 4) {
-                    wasm_v128_store(&output[frame * state->channels + ch], sample_vec);
-                }
-
-                for (; ch < state->channels; ++ch) {
-                    output[frame * state->channels + ch] = sample;
-                }
-            } else
-#endif
-            {
-                for (int ch = 0; ch < state->channels; ++ch) {
-                    output[frame * state->channels + ch] = sample;
-                }
-            }
+    state->phase += frame_count * phase_increment;
+    state->phase -= std::floor(state->phase);
+}
 
-            // Update phase
-            state->phase += phase_increment;
-            if (state->phase >= 1.0) {
-                state->phase -= 1.0;
-            }
+// Oscillator with audio-rate frequency and detune (FM, vibrato from an LFO):
+// the phase advances by each frame's own frequency. Each group of four frames
+// reads the table for its highest frequency. Modulation can push the frequency
+// negative or past Nyquist, so the phase is wrapped both ways.
+EMSCRIPTEN_KEEPALIVE
+void processOscillatorNodeARate(
+    OscillatorNodeState* state,
+    float* output,
+    int frame_count,
+    const float* frequency,
+    const float* detune
+) {
+    if (!state) return;
+
+    const WaveTableSet* set = waveTables(state);
+    if (!state->is_active || !set) {
+        memset(output, 0, frame_count * state->channels * sizeof(float));
+        return;
+    }
+
+    const double inv_sample_rate = 1.0 / static_cast<double>(state->sample_rate);
+    const float nyquist = state->sample_rate * 0.5f;
+    const bool sine = state->wave_type == WaveType::SINE;
+    double phase = state->phase;
+    for (int frame = 0; frame < frame_count; frame += 4) {
+        const int count = std::min(4, frame_count - frame);
+        double phases[4];
+        float highest = 0.0f;
+        for (int k = 0; k < 4; ++k) {
+            phases[k] = phase;
+            if (k >= count) continue;
+            float actual_frequency = frequency[frame + k];
+            if (detune[frame + k] != 0.0f) actual_frequency *= std::pow(2.0f, detune[frame + k] / 1200.0f);
+            if (!std::isfinite(actual_frequency)) actual_frequency = 0.0f;
+            highest = std::max(highest, std::fabs(actual_frequency));
+            phase += actual_frequency * inv_sample_rate;
+            phase -= std::floor(phase);
         }
+        float samples[4];
+        renderSamples4(sine, selectWaveTable(set, highest, nyquist), phases, samples);
+#ifdef __wasm_simd128__
+        if (count == 4) {
+            storeFrames4(output, state->channels, frame, wasm_v128_load(samples));
+            continue;
+        }
+#endif
+        writeFrames(output, state->channels, frame, samples, count);
     }
+    state->phase = phase;
 }
 
 } // extern "C"
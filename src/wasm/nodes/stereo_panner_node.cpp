@@ -73,4 +73,29 @@ void processStereoPannerNode(
     }
 }
 
+// Panning with an audio-rate pan (auto-pan from an LFO): equal-power gains per
+// frame.
+EMSCRIPTEN_KEEPALIVE
+void processStereoPannerNodeARate(
+    StereoPannerNodeState* state,
+    float* input,
+    float* output,
+    int frame_count,
+    int input_channels,
+    const float* pan
+) {
+    if (!state) return;
+
+    for (int i = 0; i < frame_count; i++) {
+        const float p = fmaxf(-1.0f, fminf(1.0f, pan[i]));
+        const float angle = (p + 1.0f) * 0.25f * static_cast<float>(M_PI);
+        const float gain_l = cosf(angle);
+        const float gain_r = sinf(angle);
+        const float left = input_channels == 1 ? input[i] : input[i * 2];
+        const float right = input_channels == 1 ? input[i] : input[i * 2 + 1];
+        output[i * 2] = left * gain_l;
+        output[i * 2 + 1] = right * gain_r;
+    }
+}
+
 } // extern "C"
@@ -33,6 +33,13 @@ struct AutomationEvent {
 };
 
 // AudioParam state
+//
+// Events are kept sorted by time (equal times in the order they were
+// scheduled). Rendering only moves forward, so a cursor moves through the
+// timeline with it: the events before `cursor` have taken effect and are folded
+// into the anchor, the curve the value follows from anchor_time until the next
+// event - held, a setTarget approach or a value curve. Folded events are erased
+// in batches.
 struct AudioParamState {
     float current_value;
     float default_value;
@@ -40,10 +47,17 @@ struct AudioParamState {
     float max_value;
 
     std::vector<AutomationEvent> events;
-
-    // For tracking time
-    double last_time;
-    float last_computed_value;
+    size_t cursor;
+
+    bool anchored;          // until the first event takes effect, current_value holds
+    float anchor_value;
+    double anchor_time;
+    bool anchor_target;     // a setTarget approach is running from the anchor
+    float target_value;
+    double target_time_constant;
+    float* anchor_curve;    // a value curve is running from anchor_time (owned)
+    int anchor_curve_length;
+    double anchor_curve_duration;
 };
 
 // Clamp value to min/max range
@@ -53,6 +67,225 @@ static inline float ClampValue(float value, float min_val, float max_val) {
     return value;
 }
 
+// Insert keeping the timeline sorted; after events at the same time. Events
+// before the cursor are in the past, so the search starts there.
+static void InsertEvent(AudioParamState* state, const AutomationEvent& event) {
+    std::vector<AutomationEvent>& events = state->events;
+    auto it = std::upper_bound(events.begin() + state->cursor, events.end(), event.time,
+        [](double time, const AutomationEvent& e) { return time < e.time; });
+    events.insert(it, event);
+}
+
+// Value `elapsed` seconds into a value curve: linear interpolation between its
+// points, spread evenly over `duration`; the last point from the end on.
+static double CurveValueAt(const float* curve, int length, double duration, double elapsed) {
+    const double pos = std::max(0.0, elapsed) * (length - 1) / duration;
+    if (pos >= length - 1) return curve[length - 1];
+    const int k = static_cast<int>(pos);
+    return curve[k] + (curve[k + 1] - curve[k]) * (pos - k);
+}
+
+// Value of the anchor curve at `time` (no earlier than the anchor)
+static double AnchorValueAt(const AudioParamState* state, double time) {
+    if (!state->anchored) return state->current_value;
+    if (state->anchor_curve) {
+        return CurveValueAt(state->anchor_curve, state->anchor_curve_length, state->anchor_curve_duration,
+                            time - state->anchor_time);
+    }
+    if (!state->anchor_target) return state->anchor_value;
+    double elapsed = std::max(0.0, time - state->anchor_time);
+    double tau = state->target_time_constant > 1e-9 ? state->target_time_constant : 1e-9;
+    return state->target_value + (state->anchor_value - state->target_value) * std::exp(-elapsed / tau);
+}
+
+// Fold every event that has taken effect by `time` into the anchor. Each event
+// is visited once; lookups cost O(1) amortized however long the timeline is.
+static void AdvanceTo(AudioParamState* state, double time) {
+    std::vector<AutomationEvent>& events = state->events;
+    while (state->cursor < events.size() && events[state->cursor].time <= time) {
+        AutomationEvent& e = events[state->cursor++];
+        // Approach from wherever the previous curve had got to
+        const float start_value = (float)AnchorValueAt(state, e.time);
+        delete[] state->anchor_curve;
+        state->anchor_curve = nullptr;
+        state->anchor_target = false;
+        state->anchor_value = e.value;
+        if (e.type == EventType::SET_TARGET) {
+            state->anchor_value = start_value;
+            state->anchor_target = true;
+            state->target_value = e.value;
+            state->target_time_constant = e.time_constant;
+        } else if (e.type == EventType::SET_CURVE) {
+            // The anchor takes the curve's points over from the event
+            state->anchor_curve = e.curve_values;
+            state->anchor_curve_length = e.curve_length;
+            state->anchor_curve_duration = e.duration;
+            e.curve_values = nullptr;
+        }
+        state->anchor_time = e.time;
+        state->anchored = true;
+    }
+
+    // A finished value curve holds its last point
+    if (state->anchor_curve && time >= state->anchor_time + state->anchor_curve_duration) {
+        state->anchor_value = state->anchor_curve[state->anchor_curve_length - 1];
+        state->anchor_time += state->anchor_curve_duration;
+        delete[] state->anchor_curve;
+        state->anchor_curve = nullptr;
+    }
+
+    // A ramp following a running setTarget starts from the approach's value
+    // at the time rendering reaches it
+    if (state->anchor_target && state->cursor < events.size() &&
+        (events[state->cursor].type == EventType::LINEAR_RAMP ||
+         events[state->cursor].type == EventType::EXPONENTIAL_RAMP)) {
+        state->anchor_value = (float)AnchorValueAt(state, time);
+        state->anchor_time = time;
+        state->anchor_target = false;
+    }
+
+    // Erase the folded events once they are half the timeline
+    if (state->cursor >= 32 && state->cursor * 2 >= events.size()) {
+        events.erase(events.begin(), events.begin() + state->cursor);
+        state->cursor = 0;
+    }
+}
+
+// The piece of the timeline a span of frames falls in: from `time` until
+// `end_time` (the next event) the value follows one curve.
+//
+//   HOLD      value
+//   LINEAR    value + slope * dt
+//   GEOMETRIC offset + scale * exp(log_rate * dt)   (exponential ramp: offset 0;
+//                                                    setTarget: offset = target)
+//   CURVE     curve interpolated at point offset + slope * dt
+enum class SegmentShape { HOLD, LINEAR, GEOMETRIC, CURVE };
+
+struct Segment {
+    SegmentShape shape;
+    float value;        // at the segment's start
+    double end_time;
+    double slope;       // LINEAR, per second
+    double offset;      // GEOMETRIC
+    double scale;
+    double log_rate;    // GEOMETRIC, per second
+    const float* curve = nullptr;
+    int curve_length = 0;
+};
+
+// The segment `time` falls in. Moves the cursor up to `time`.
+static Segment SegmentAt(AudioParamState* state, double time) {
+    AdvanceTo(state, time);
+    const double value = AnchorValueAt(state, time);
+    const AutomationEvent* next = state->cursor < state->events.size() ? &state->events[state->cursor] : nullptr;
+    const double end_time = next ? next->time : 1e300;
+
+    if (state->anchor_curve) {
+        const double curve_end = state->anchor_time + state->anchor_curve_duration;
+        const double points_per_second = (state->anchor_curve_length - 1) / state->anchor_curve_duration;
+        return {SegmentShape::CURVE, static_cast<float>(value), std::min(end_time, curve_end),
+                points_per_second, (time - state->anchor_time) * points_per_second, 0.0, 0.0,
+                state->anchor_curve, state->anchor_curve_length};
+    }
+
+    // Ramps interpolate from the anchor to the next event's value
+    if (next && (next->type == EventType::LINEAR_RAMP || next->type == EventType::EXPONENTIAL_RAMP)) {
+        const double span = next->time - state->anchor_time;
+        const double elapsed = std::max(0.0, time - state->anchor_time);
+        if (next->type == EventType::LINEAR_RAMP && span > 0) {
+            const double slope = (next->value - value) / span;
+            return {SegmentShape::LINEAR, static_cast<float>(value + slope * elapsed), end_time, slope, 0.0, 0.0, 0.0};
+        }
+        if (next->type == EventType::EXPONENTIAL_RAMP && span > 0 && value > 0.0 && next->value > 0.0f) {
+            const double log_rate = std::log(next->value / value) / span;
+            const double start = value * std::exp(log_rate * elapsed);
+            return {SegmentShape::GEOMETRIC, static_cast<float>(start), end_time, 0.0, 0.0, start, log_rate};
+        }
+    }
+
+    if (state->anchor_target) {
+        const double tau = state->target_time_constant > 1e-9 ? state->target_time_constant : 1e-9;
+        return {SegmentShape::GEOMETRIC, static_cast<float>(value), end_time, 0.0, state->target_value,
+                value - state->target_value, -1.0 / tau};
+    }
+    return {SegmentShape::HOLD, static_cast<float>(value), end_time, 0.0, 0.0, 0.0, 0.0};
+}
+
+// Write `count` frames of a segment, starting `dt` seconds per frame apart,
+// clamped to [min_value, max_value]. Ramps and setTarget curves are generated
+// four frames at a time: linear from the frame index, geometric by repeated
+// multiplication with the per-frame ratio. Value curves are interpolated frame
+// by frame.
+static void RenderSegment(const Segment& seg, float* out, int count, double dt, float min_value, float max_value) {
+    int i = 0;
+    switch (seg.shape) {
+        case SegmentShape::HOLD: {
+            const float value = ClampValue(seg.value, min_value, max_value);
+            std::fill(out, out + count, value);
+            return;
+        }
+        case SegmentShape::LINEAR: {
+            const float start = seg.value;
+            const float step = static_cast<float>(seg.slope * dt);
+#ifdef __wasm_simd128__
+            const v128_t lo = wasm_f32x4_splat(min_value);
+            const v128_t hi = wasm_f32x4_splat(max_value);
+            v128_t index = wasm_f32x4_make(0.0f, 1.0f, 2.0f, 3.0f);
+            const v128_t four = wasm_f32x4_splat(4.0f);
+            const v128_t start_vec = wasm_f32x4_splat(start);
+            const v128_t step_vec = wasm_f32x4_splat(step);
+            for (; i + 4 <= count; i += 4) {
+                v128_t v = wasm_f32x4_add(start_vec, wasm_f32x4_mul(step_vec, index));
+                wasm_v128_store(&out[i], wasm_f32x4_min(wasm_f32x4_max(v, lo), hi));
+                index = wasm_f32x4_add(index, four);
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i] = ClampValue(start + step * static_cast<float>(i), min_value, max_value);
+            }
+            return;
+        }
+        case SegmentShape::GEOMETRIC: {
+            const float offset = static_cast<float>(seg.offset);
+            const double ratio = std::exp(seg.log_rate * dt);
+#ifdef __wasm_simd128__
+            const v128_t lo = wasm_f32x4_splat(min_value);
+            const v128_t hi = wasm_f32x4_splat(max_value);
+            const v128_t offset_vec = wasm_f32x4_splat(offset);
+            const double r2 = ratio * ratio;
+            v128_t scale = wasm_f32x4_make(static_cast<float>(seg.scale), static_cast<float>(seg.scale * ratio),
+                                           static_cast<float>(seg.scale * r2), static_cast<float>(seg.scale * r2 * ratio));
+            const v128_t ratio4 = wasm_f32x4_splat(static_cast<float>(r2 * r2));
+            for (; i + 4 <= count; i += 4) {
+                v128_t v = wasm_f32x4_add(offset_vec, scale);
+                wasm_v128_store(&out[i], wasm_f32x4_min(wasm_f32x4_max(v, lo), hi));
+                scale = wasm_f32x4_mul(scale, ratio4);
+            }
+#endif
+            double scale_value = seg.scale * std::pow(ratio, i);
+            for (; i < count; ++i) {
+                out[i] = ClampValue(static_cast<float>(seg.offset + scale_value), min_value, max_value);
+                scale_value *= ratio;
+            }
+            return;
+        }
+        case SegmentShape::CURVE: {
+            const double step = seg.slope * dt;
+            const int last = seg.curve_length - 1;
+            for (; i < count; ++i) {
+                const double pos = seg.offset + step * i;
+                float value = seg.curve[last];
+                if (pos < last) {
+                    const int k = static_cast<int>(pos);
+                    value = seg.curve[k] + (seg.curve[k + 1] - seg.curve[k]) * static_cast<float>(pos - k);
+                }
+                out[i] = ClampValue(value, min_value, max_value);
+            }
+            return;
+        }
+    }
+}
+
 // Create new AudioParam
 extern "C" {
 
@@ -63,8 +296,16 @@ AudioParamState* createAudioParam(float default_value, float min_value, float ma
     state->default_value = default_value;
     state->min_value = min_value;
     state->max_value = max_value;
-    state->last_time = 0.0;
-    state->last_computed_value = default_value;
+    state->cursor = 0;
+    state->anchored = false;
+    state->anchor_value = default_value;
+    state->anchor_time = -1e300;
+    state->anchor_target = false;
+    state->target_value = default_value;
+    state->target_time_constant = 0.0;
+    state->anchor_curve = nullptr;
+    state->anchor_curve_length = 0;
+    state->anchor_curve_duration = 0.0;
     return state;
 }
 
@@ -78,6 +319,7 @@ void destroyAudioParam(AudioParamState* state) {
             delete[] event.curve_values;
         }
     }
+    delete[] state->anchor_curve;
 
     delete state;
 }
@@ -107,7 +349,7 @@ void setParamValueAtTime(AudioParamState* state, float value, double time) {
     event.curve_values = nullptr;
     event.curve_length = 0;
 
-    state->events.push_back(event);
+    InsertEvent(state, event);
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -123,7 +365,7 @@ void linearRampToValueAtTime(AudioParamState* state, float value, double time) {
     event.curve_values = nullptr;
     event.curve_length = 0;
 
-    state->events.push_back(event);
+    InsertEvent(state, event);
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -139,7 +381,7 @@ void exponentialRampToValueAtTime(AudioParamState* state, float value, double ti
     event.curve_values = nullptr;
     event.curve_length = 0;
 
-    state->events.push_back(event);
+    InsertEvent(state, event);
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -155,88 +397,87 @@ void setTargetAtTime(AudioParamState* state, float target, double time, double t
     event.curve_values = nullptr;
     event.curve_length = 0;
 
-    state->events.push_back(event);
+    InsertEvent(state, event);
+}
+
+// Value curve: `length` points spread evenly over [time, time + duration],
+// interpolated linearly. The points are copied.
+EMSCRIPTEN_KEEPALIVE
+void setValueCurveAtTime(AudioParamState* state, const float* values, int length, double time, double duration) {
+    if (!state || !values || length <= 0 || duration <= 0.0) return;
+
+    AutomationEvent event;
+    event.type = EventType::SET_CURVE;
+    event.time = time;
+    event.value = ClampValue(values[length - 1], state->min_value, state->max_value);
+    event.time_constant = 0.0;
+    event.duration = duration;
+    event.curve_values = new float[length];
+    memcpy(event.curve_values, values, length * sizeof(float));
+    event.curve_length = length;
+
+    InsertEvent(state, event);
 }
 
 EMSCRIPTEN_KEEPALIVE
 void cancelScheduledParamValues(AudioParamState* state, double cancel_time) {
     if (!state) return;
 
-    // Remove all events after cancel_time
-    state->events.erase(
-        std::remove_if(state->events.begin(), state->events.end(),
-            [cancel_time](const AutomationEvent& e) { return e.time >= cancel_time; }),
-        state->events.end()
-    );
+    // Remove all events at or after cancel_time: a tail of the sorted timeline
+    std::vector<AutomationEvent>& events = state->events;
+    auto first = std::lower_bound(events.begin(), events.end(), cancel_time,
+        [](const AutomationEvent& e, double time) { return e.time < time; });
+    for (auto it = first; it != events.end(); ++it) delete[] it->curve_values;
+    events.erase(first, events.end());
+    if (state->cursor > events.size()) state->cursor = events.size();
 }
 
-// Get parameter value at specific time (with automation)
+// Get parameter value at specific time (with automation). Times are expected
+// to move forward from call to call, as rendering does: the events before the
+// time asked for are folded away.
 EMSCRIPTEN_KEEPALIVE
 float getParamValueAtTime(AudioParamState* state, double time, int sample_rate) {
-    if (!state || state->events.empty()) {
-        return state ? state->current_value : 0.0f;
-    }
+    if (!state) return 0.0f;
+    if (state->events.empty() && !state->anchored) return state->current_value;
 
-    // Sort events by time
-    std::sort(state->events.begin(), state->events.end(),
-        [](const AutomationEvent& a, const AutomationEvent& b) { return a.time < b.time; });
-
-    // Walk the timeline tracking (prevTime, prevValue) = the value just AFTER the
-    // last event at or before `time`. Crucially, when `time` falls INSIDE a ramp
-    // (i.e. the next event is a ramp ending in the future), interpolate toward it
-    // — the previous version broke on the first future event and so only applied
-    // ramps AFTER they ended (a step, not a glide).
-    float prevValue = state->current_value;
-    double prevTime = -1e300;
-
-    for (size_t i = 0; i < state->events.size(); ++i) {
-        AutomationEvent& e = state->events[i];
-
-        if (e.time > time) {
-            // We're between prevTime and this future event — interpolate if it's a
-            // ramp (ramps interpolate from prevValue starting at prevTime).
-            if (e.type == EventType::LINEAR_RAMP) {
-                double span = e.time - prevTime;
-                if (span <= 0) return ClampValue(e.value, state->min_value, state->max_value);
-                double t = std::max(0.0, std::min(1.0, (time - prevTime) / span));
-                return ClampValue((float)(prevValue + t * (e.value - prevValue)),
-                                  state->min_value, state->max_value);
-            }
-            if (e.type == EventType::EXPONENTIAL_RAMP) {
-                double span = e.time - prevTime;
-                if (span <= 0 || prevValue <= 0.0f || e.value <= 0.0f)
-                    return ClampValue(prevValue, state->min_value, state->max_value);
-                double t = std::max(0.0, std::min(1.0, (time - prevTime) / span));
-                return ClampValue((float)(prevValue * std::pow((double)e.value / prevValue, t)),
-                                  state->min_value, state->max_value);
-            }
-            // SET_VALUE / SET_CURVE take effect AT their time; before that, hold.
-            // SET_TARGET starts AT its time; before that, hold.
-            return ClampValue(prevValue, state->min_value, state->max_value);
-        }
+    return ClampValue(SegmentAt(state, time).value, state->min_value, state->max_value);
+}
 
-        // e.time <= time: this event has taken effect; advance (prevTime,prevValue).
-        switch (e.type) {
-            case EventType::SET_VALUE:
-            case EventType::LINEAR_RAMP:
-            case EventType::EXPONENTIAL_RAMP:
-            case EventType::SET_CURVE:
-                prevValue = e.value;
-                prevTime = e.time;
-                break;
-            case EventType::SET_TARGET: {
-                double elapsed = time - e.time;
-                double tau = e.time_constant > 1e-9 ? e.time_constant : 1e-9;
-                prevValue = (float)(e.value + (prevValue - e.value) * std::exp(-elapsed / tau));
-                prevTime = time;  // continuous; value already advanced to `time`
-                break;
-            }
-        }
+// Render the param's value for `frame_count` frames starting at `start_time`,
+// one value per frame (sample-accurate automation). Returns 1 when the values
+// change within the span and all of `values` was written; 0 when the value is
+// constant over the span, in which case only values[0] is written.
+EMSCRIPTEN_KEEPALIVE
+int renderParamValues(AudioParamState* state, double start_time, int sample_rate, float* values, int frame_count) {
+    if (!state) {
+        values[0] = 0.0f;
+        return 0;
     }
+    // Fast path: nothing scheduled
+    if (state->events.empty() && !state->anchored) {
+        values[0] = state->current_value;
+        return 0;
+    }
+
+    const double dt = 1.0 / sample_rate;
+    int frame = 0;
+    while (frame < frame_count) {
+        const double time = start_time + frame * dt;
+        const Segment seg = SegmentAt(state, time);
 
-    float value = prevValue;
+        // Frames before the segment's end event takes effect
+        int count = frame_count - frame;
+        const double frames_left = std::ceil((seg.end_time - time) * sample_rate);
+        if (frames_left < count) count = frames_left < 1.0 ? 1 : static_cast<int>(frames_left);
 
-    return ClampValue(value, state->min_value, state->max_value);
+        if (frame == 0 && count == frame_count && seg.shape == SegmentShape::HOLD) {
+            values[0] = ClampValue(seg.value, state->min_value, state->max_value);
+            return 0;
+        }
+        RenderSegment(seg, values + frame, count, dt, state->min_value, state->max_value);
+        frame += count;
+    }
+    return 1;
 }
 
 } // extern "C"
@@ -1,7 +1,10 @@
 // Comprehensive Web Audio API Test Suite
 // Tests all nodes, parameters, and features
 
+import { Writable } from 'stream';
 import { OfflineAudioContext } from '../index.js';
+import { LatencyController } from '../src/wasm-integration/LatencyController.js';
+import { WorkerRenderEngine } from '../src/wasm-integration/RenderThread.js';
 
 let passed = 0;
 let failed = 0;
@@ -501,6 +504,851 @@ console.log('\nTest 20: AudioBufferSourceNode.loop');
     assert(onceTailPeak === 0, 'Non-looping source is silent past the buffer length');
 }
 
+// Test 21: Every input to a node is summed, and shared sources render once
+console.log('\nTest 21: Input Summing and Fan-out');
+{
+    const sampleRate = 8000;
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 1600, sampleRate });
+
+    // Two DC sources into one lowpass: DC passes, so the output settles at their sum.
+    const a = ctx.createConstantSource();
+    const b = ctx.createConstantSource();
+    a.offset.value = 0.25;
+    b.offset.value = 0.5;
+    const filter = ctx.createBiquadFilter();
+    a.connect(filter);
+    b.connect(filter);
+    filter.connect(ctx.destination);
+
+    // One source fanned out to two gains that both reach the destination.
+    const shared = ctx.createConstantSource();
+    shared.offset.value = 0.1;
+    const left = ctx.createGain();
+    const right = ctx.createGain();
+    shared.connect(left);
+    shared.connect(right);
+    left.connect(ctx.destination);
+    right.connect(ctx.destination);
+
+    a.start(0);
+    b.start(0);
+    shared.start(0);
+    const data = (await ctx.startRendering()).getChannelData(0);
+
+    assertApprox(data[1500], 0.95, 0.01, 'Filter sums both inputs, fan-out sums both branches');
+}
+
+// Test 22: Destroyed nodes leave the graph with all of their connections
+console.log('\nTest 22: Node Destruction');
+{
+    const sampleRate = 8000;
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 800, sampleRate });
+
+    const kept = ctx.createConstantSource();
+    const dropped = ctx.createConstantSource();
+    kept.offset.value = 0.25;
+    dropped.offset.value = 0.5;
+    const gain = ctx.createGain();
+    kept.connect(gain);
+    dropped.connect(gain);
+    gain.connect(ctx.destination);
+    kept.start(0);
+    dropped.start(0);
+
+    ctx._engine.destroyNode(dropped._nodeId);
+    // A destroyed handle is dead: reconnecting it must not bring the node back.
+    ctx._engine.connectNodes(dropped._nodeId, gain._nodeId);
+    const data = (await ctx.startRendering()).getChannelData(0);
+
+    assertApprox(data[400], 0.25, 0.001, 'Only the surviving source reaches the output');
+}
+
+// Test 23: A delay keeps playing its tail after the source feeding it ends
+console.log('\nTest 23: Tail After Source Ends');
+{
+    const sampleRate = 8000;
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 2400, sampleRate });
+    const buffer = ctx.createBuffer(1, 400, sampleRate);
+    buffer.getChannelData(0).fill(0.5);
+
+    const source = ctx.createBufferSource();
+    source.buffer = buffer;
+    const delay = ctx.createDelay(1);
+    delay.delayTime.value = 0.1; // 800 frames
+    source.connect(delay);
+    delay.connect(ctx.destination);
+    source.start(0);
+
+    const data = (await ctx.startRendering()).getChannelData(0);
+
+    assertApprox(data[1000], 0.5, 0.01, 'Echo is heard after the source has finished');
+    assertApprox(data[2000], 0, 0.001, 'Output is silent once the tail has played out');
+}
+
+// Test 24: Offline rendering reports progress from the native render loop
+console.log('\nTest 24: Render Progress');
+{
+    const ctx = new OfflineAudioContext({
+        numberOfChannels: 1,
+        length: 128 * 25,
+        sampleRate: 8000,
+        progressQuanta: 10
+    });
+    const source = ctx.createConstantSource();
+    source.connect(ctx.destination);
+    source.start(0);
+
+    const reports = [];
+    ctx.onprogress = (framesRendered, totalFrames) => reports.push([framesRendered, totalFrames]);
+    const data = (await ctx.startRendering()).getChannelData(0);
+
+    assert(
+        JSON.stringify(reports) === JSON.stringify([[1280, 3200], [2560, 3200], [3200, 3200]]),
+        'Progress reported every 10 quanta and at the end'
+    );
+    assertApprox(data[3199], 1, 0.001, 'Whole length rendered in one call');
+}
+
+// Test 25: Rendered channels land in their own AudioBuffer channels
+console.log('\nTest 25: Planar Render Output');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 2, length: 1000, sampleRate: 8000 });
+    const source = ctx.createConstantSource();
+    const panner = ctx.createStereoPanner();
+    panner.pan.value = 1;
+    source.connect(panner);
+    panner.connect(ctx.destination);
+    source.start(0);
+
+    const rendered = await ctx.startRendering();
+
+    assertApprox(
+        rendered.getChannelData(0)[999],
+        0,
+        0.001,
+        'Left channel is silent when panned hard right'
+    );
+    assertApprox(rendered.getChannelData(1)[999], 1, 0.001, 'Right channel carries the source');
+    assertApprox(
+        rendered._getInterleavedData()[1],
+        1,
+        0.001,
+        'Interleaved view rebuilt from the channels'
+    );
+}
+
+// Test 26: Streaming render pushes fixed-size chunks to a callback or a Writable
+console.log('\nTest 26: Streaming Render');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 2, length: 1000, sampleRate: 8000 });
+    const source = ctx.createConstantSource();
+    source.offset.value = 0.5;
+    source.connect(ctx.destination);
+    source.start(0);
+
+    const sizes = [];
+    let last = 0;
+    const frames = await ctx.startStreaming(
+        (chunk, framesRendered) => {
+            sizes.push(chunk.length / 2);
+            last = chunk[chunk.length - 1];
+            assert(
+                framesRendered === sizes.reduce((a, b) => a + b, 0),
+                'framesRendered counts the chunks so far'
+            );
+        },
+        { chunkFrames: 300 }
+    );
+
+    assert(frames === 1000, 'Streaming resolves to the rendered length');
+    assert(
+        JSON.stringify(sizes) === '[300,300,300,100]',
+        'Chunks are chunkFrames long, the last one shorter'
+    );
+    assertApprox(last, 0.5, 0.001, 'Chunks carry the rendered audio');
+
+    const streamCtx = new OfflineAudioContext({
+        numberOfChannels: 2,
+        length: 1000,
+        sampleRate: 8000
+    });
+    const streamSource = streamCtx.createConstantSource();
+    streamSource.connect(streamCtx.destination);
+    streamSource.start(0);
+
+    const parts = [];
+    const writable = new Writable({
+        highWaterMark: 1024,
+        write(part, encoding, callback) {
+            parts.push(part);
+            setImmediate(callback);
+        }
+    });
+    const finished = new Promise(resolve => writable.on('finish', resolve));
+    await streamCtx.startStreaming(writable, { chunkFrames: 256 });
+    await finished;
+
+    const bytes = Buffer.concat(parts);
+    assert(bytes.length === 1000 * 2 * 4, 'Writable receives every frame as float32 PCM');
+    assertApprox(
+        bytes.readFloatLE(bytes.length - 4),
+        1,
+        0.001,
+        'Writable is ended after the last chunk'
+    );
+
+    for (const chunkFrames of [0, -128, 12.5, NaN]) {
+        const badCtx = new OfflineAudioContext({
+            numberOfChannels: 1,
+            length: 1000,
+            sampleRate: 8000
+        });
+        let error = null;
+        try {
+            await badCtx.startStreaming(() => {}, { chunkFrames });
+        } catch (e) {
+            error = e;
+        }
+        assert(
+            error instanceof RangeError,
+            `chunkFrames ${chunkFrames} is rejected with RangeError`
+        );
+        assert(badCtx.state === 'suspended', 'and the context is left unrendered');
+    }
+}
+
+// Test 27: The realtime queue depth follows latencyHint and adapts to underruns
+console.log('\nTest 27: Adaptive Latency');
+{
+    const latency = new LatencyController('interactive', 48000);
+    assert(latency.target <= 0.04, `interactive starts at ${latency.target * 1000}ms of queue`);
+    assert(latency.deviceFrames <= 512, `device buffer is ${latency.deviceFrames} frames`);
+    assert(
+        latency.framesToQueue(latency.target) === 0,
+        'nothing to render when the queue is at target'
+    );
+
+    // Clean playback shrinks the queue, one step per interval, down to the floor
+    const start = latency.target;
+    latency.reset(0);
+    latency.update(0.02, 1000);
+    assert(latency.target === start, 'no shrink before the interval has passed');
+    for (let t = 2000; t <= 60000; t += 2000) latency.update(0.02, t);
+    assertApprox(latency.target, latency.min, 1e-9, 'shrinks to the floor while clean');
+
+    // An underrun grows it again
+    latency.update(0, 61000);
+    assert(latency.underruns === 1 && latency.target > latency.min, 'grows after an underrun');
+
+    assert(
+        new LatencyController(0.1, 48000).target === 0.1,
+        'numeric latencyHint is the starting target'
+    );
+    assert(new LatencyController('playback', 48000).target >= 0.2, 'playback keeps a deep queue');
+    let threw = false;
+    try {
+        new LatencyController('fast', 48000);
+    } catch (e) {
+        threw = e instanceof TypeError;
+    }
+    assert(threw, 'unknown latencyHint throws TypeError');
+
+    // A stall tolerance keeps the queue that much deeper than the target
+    const tolerant = new LatencyController('interactive', 48000, 0.1);
+    assertApprox(
+        tolerant.queueTarget,
+        tolerant.target + 0.1,
+        1e-9,
+        'queue target adds the tolerance'
+    );
+    assert(
+        tolerant.framesToQueue(tolerant.target) >= 4800,
+        'refills past the target by the tolerance'
+    );
+    threw = false;
+    try {
+        new LatencyController('interactive', 48000, -1);
+    } catch (e) {
+        threw = e instanceof TypeError;
+    }
+    assert(threw, 'negative stallTolerance throws TypeError');
+}
+
+// Test 28: The opt-in profiler times each node and each node type
+console.log('\nTest 28: Graph Profile');
+{
+    const ctx = new OfflineAudioContext({
+        numberOfChannels: 2,
+        length: 12800,
+        sampleRate: 44100,
+        profile: true
+    });
+    const osc = ctx.createOscillator();
+    const delay = ctx.createDelay(1);
+    const gain = ctx.createGain();
+    osc.connect(delay);
+    delay.connect(gain);
+    gain.connect(ctx.destination);
+    osc.start(0);
+    await ctx.startRendering();
+
+    const profile = ctx.getGraphProfile();
+    assert(profile.nodes.length === 4, `${profile.nodes.length} nodes profiled`);
+    assert(profile.nodes.every(node => node.calls === 100), 'each node processed once per quantum');
+    assert(
+        profile.types.delay && profile.types.delay.bytes >= 44100 * 4,
+        'delay line allocation counted'
+    );
+    assert(
+        profile.overhead && profile.overhead.calls === 100,
+        'graph overhead reported per quantum'
+    );
+
+    const plain = new OfflineAudioContext({ numberOfChannels: 1, length: 128, sampleRate: 44100 });
+    await plain.startRendering();
+    assert(plain.getGraphProfile() === null, 'no profile unless asked for');
+}
+
+// Test 29: A traced render exports Chrome Trace Event JSON
+console.log('\nTest 29: Trace Export');
+{
+    const ctx = new OfflineAudioContext({
+        numberOfChannels: 1,
+        length: 256,
+        sampleRate: 44100,
+        trace: true
+    });
+    const osc = ctx.createOscillator();
+    const gain = ctx.createGain();
+    gain.gain.value = 0.5;
+    osc.connect(gain);
+    gain.connect(ctx.destination);
+    osc.start(0);
+    await ctx.startRendering();
+
+    const trace = JSON.parse(JSON.stringify(ctx.getTrace()));
+    const events = trace.traceEvents;
+    const slices = name => events.filter(e => e.ph === 'X' && e.name === name);
+    assert(slices('quantum').length === 2, 'one slice per quantum');
+    assert(
+        slices('oscillator').length === 2 && slices('gain').length === 2,
+        'one slice per node per quantum'
+    );
+    assert(
+        slices('gain').every(e => e.dur >= 0 && e.ts > 0),
+        'slices carry timestamps and durations'
+    );
+    assert(
+        events.some(e => e.ph === 'i' && e.name === 'start oscillator'),
+        'start is an instant event'
+    );
+    assert(
+        events.some(e => e.ph === 'i' && e.name === 'gain.gain' && e.args.value === 0.5),
+        'param change is an instant event'
+    );
+    assert(
+        events.some(e => e.ph === 'C' && e.name === 'heap' && e.args.bytes > 0),
+        'heap size counter'
+    );
+    assert(trace.otherData.droppedEvents === 0, 'nothing dropped');
+}
+
+// Test 30: Graph changes are batched and applied in order, past a buffer's worth
+console.log('\nTest 30: Batched Graph Commands');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 256, sampleRate: 44100 });
+    const src = ctx.createConstantSource();
+    const gain = ctx.createGain();
+    src.connect(gain);
+    gain.connect(ctx.destination);
+    // More sets than fit in one command buffer: the last one must win
+    for (let i = 0; i < 6000; i++) {
+        gain.gain.value = i / 6000;
+    }
+    gain.gain.value = 0.25;
+    src.start(0);
+    src.stop(128 / 44100);
+    const buffer = await ctx.startRendering();
+    const data = buffer.getChannelData(0);
+    assertApprox(data[64], 0.25, 1e-6, 'last queued value applied');
+    assertApprox(data[200], 0, 1e-6, 'queued stop applied');
+}
+
+// Test 31: Oscillator and filter types reach the native nodes
+console.log('\nTest 31: Node Types');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 4096, sampleRate: 44100 });
+    const osc = ctx.createOscillator();
+    osc.type = 'square';
+    osc.frequency.value = 100;
+    osc.connect(ctx.destination);
+    osc.start(0);
+    const square = (await ctx.startRendering()).getChannelData(0);
+    const full = square.subarray(16).filter(v => Math.abs(v) > 0.9).length;
+    assert(full > 0.95 * (square.length - 16), 'square oscillator renders a square wave');
+
+    const dcCtx = new OfflineAudioContext({ numberOfChannels: 1, length: 8192, sampleRate: 44100 });
+    const dc = dcCtx.createConstantSource();
+    const filter = dcCtx.createBiquadFilter();
+    filter.type = 'highpass';
+    dc.connect(filter);
+    filter.connect(dcCtx.destination);
+    dc.start(0);
+    const filtered = (await dcCtx.startRendering()).getChannelData(0);
+    assertApprox(filtered[8191], 0, 0.01, 'highpass filter removes DC');
+}
+
+// Test 32: A node connected to an AudioParam modulates it at audio rate
+console.log('\nTest 32: AudioParam Connections');
+{
+    const render = async modulate => {
+        const ctx = new OfflineAudioContext({
+            numberOfChannels: 1,
+            length: 1024,
+            sampleRate: 44100
+        });
+        const carrier = ctx.createConstantSource();
+        const amp = ctx.createGain();
+        const lfo = ctx.createOscillator();
+        lfo.frequency.value = 440;
+        carrier.connect(amp);
+        amp.connect(ctx.destination);
+        if (modulate) {
+            amp.gain.value = 0;
+            lfo.connect(amp.gain);
+        }
+        carrier.start(0);
+        lfo.start(0);
+        return (await ctx.startRendering()).getChannelData(0);
+    };
+
+    const plain = await render(false);
+    const modulated = await render(true);
+    assert(plain.every(v => Math.abs(v - 1) < 1e-6), 'unmodulated gain passes the carrier');
+    const expected = i => Math.sin((2 * Math.PI * 440 * i) / 44100);
+    assertApprox(modulated[100], expected(100), 1e-3, 'gain follows the LFO frame by frame');
+    assertApprox(modulated[1000], expected(1000), 1e-3, 'modulation holds across quanta');
+}
+
+// Test 33: Automation is rendered frame by frame, not once per quantum
+console.log('\nTest 33: Sample-Accurate Automation');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 256, sampleRate: 8000 });
+    const source = ctx.createConstantSource();
+    const amp = ctx.createGain();
+    source.connect(amp);
+    amp.connect(ctx.destination);
+    // 5 ms ramp: frames 8..48, inside the first quantum
+    amp.gain.setValueAtTime(0, 0.001);
+    amp.gain.linearRampToValueAtTime(1, 0.006);
+    source.start(0);
+    const data = (await ctx.startRendering()).getChannelData(0);
+
+    assertApprox(data[8], 0, 1e-6, 'ramp starts at its start time');
+    assertApprox(data[28], 0.5, 1e-5, 'ramp is halfway mid-quantum');
+    assertApprox(data[47], 39 / 40, 1e-5, 'ramp rises every frame');
+    assertApprox(data[200], 1, 1e-6, 'ramp holds its end value');
+}
+
+// Test 34: Long timelines scheduled out of order play back in time order
+console.log('\nTest 34: Automation Timeline Order');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 8000, sampleRate: 8000 });
+    const source = ctx.createConstantSource();
+    source.connect(ctx.destination);
+    // One step every 4 frames, scheduled last to first
+    for (let i = 1999; i >= 0; i--) {
+        source.offset.setValueAtTime(i, (i * 4) / 8000);
+    }
+    source.start(0);
+    const data = (await ctx.startRendering()).getChannelData(0);
+
+    assert(data[0] === 0 && data[5] === 1, 'early steps land on their frames');
+    assert(data[4001] === 1000, 'steps mid-render land on their frames');
+    assert(data[7999] === 1999, 'last step holds');
+}
+
+// Test 35: setValueCurveAtTime interpolates between its points
+console.log('\nTest 35: Value Curves');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 512, sampleRate: 8000 });
+    const source = ctx.createConstantSource();
+    source.connect(ctx.destination);
+    // Points 8 frames apart, from frame 16 to frame 48
+    const points = new Float32Array([0, 1, -1, 3, 2]);
+    source.offset.setValueCurveAtTime(points, 0.002, 0.004);
+    points.fill(0); // the curve was copied when scheduled
+    source.start(0);
+    const data = (await ctx.startRendering()).getChannelData(0);
+
+    assertApprox(data[16], 0, 1e-6, 'curve starts at its first point');
+    assertApprox(data[20], 0.5, 1e-5, 'curve interpolates between points');
+    assertApprox(data[36], 1, 1e-5, 'curve passes through later points');
+    assertApprox(data[300], 2, 1e-6, 'curve holds its last point');
+}
+
+// Test 36: Oscillators are band-limited
+console.log('\nTest 36: Band-Limited Oscillators');
+{
+    const render = async type => {
+        const ctx = new OfflineAudioContext({
+            numberOfChannels: 1,
+            length: 4410,
+            sampleRate: 44100
+        });
+        const osc = ctx.createOscillator();
+        osc.type = type;
+        osc.frequency.value = 5000;
+        osc.connect(ctx.destination);
+        osc.start(0);
+        return (await ctx.startRendering()).getChannelData(0);
+    };
+    const magnitude = (data, frequency) => {
+        let re = 0;
+        let im = 0;
+        for (let i = 0; i < data.length; i++) {
+            const phase = (2 * Math.PI * frequency * i) / 44100;
+            re += data[i] * Math.cos(phase);
+            im += data[i] * Math.sin(phase);
+        }
+        return (2 * Math.hypot(re, im)) / data.length;
+    };
+
+    const saw = await render('sawtooth');
+    assert(magnitude(saw, 5000) > 0.4, 'sawtooth keeps its fundamental');
+    assert(magnitude(saw, 20000) > 0.1, 'sawtooth keeps harmonics below Nyquist');
+    // A naive sawtooth's 25 kHz harmonic folds back to 19.1 kHz
+    assert(magnitude(saw, 19100) < 1e-3, 'sawtooth has no aliased harmonics');
+    const square = await render('square');
+    assert(magnitude(square, 44100 - 25000) < 1e-3, 'square has no aliased harmonics');
+}
+
+// Test 37: Stereo oscillator output
+console.log('\nTest 37: Stereo Oscillator Output');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 2, length: 44101, sampleRate: 44100 });
+    const osc = ctx.createOscillator();
+    osc.frequency.value = 1234.5;
+    osc.connect(ctx.destination);
+    osc.start(0);
+    const buffer = await ctx.startRendering();
+    const left = buffer.getChannelData(0);
+    const right = buffer.getChannelData(1);
+
+    let error = 0;
+    let identical = true;
+    for (let i = 0; i < left.length; i++) {
+        error = Math.max(error, Math.abs(left[i] - Math.sin(2 * Math.PI * ((1234.5 * i) / 44100))));
+        if (left[i] !== right[i]) identical = false;
+    }
+    assert(error < 1e-4, 'sine matches Math.sin for a whole second');
+    assert(identical, 'both channels carry the same samples');
+}
+
+// Test 38: PeriodicWave tables are synthesized natively and shared
+console.log('\nTest 38: Shared PeriodicWave Tables');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 4410, sampleRate: 44100 });
+    const real = new Float32Array(6);
+    const imag = new Float32Array([0, 1, 0.5, 0.3, 0, 0.2]);
+    const organ = ctx.createPeriodicWave(real, imag);
+    for (let i = 0; i < 64; i++) {
+        const osc = ctx.createOscillator();
+        osc.setPeriodicWave(organ);
+        osc.frequency.value = 220;
+        osc.connect(ctx.destination);
+        osc.start(0);
+    }
+    const data = (await ctx.startRendering()).getChannelData(0);
+    let peak = 0;
+    for (const sample of data) peak = Math.max(peak, Math.abs(sample));
+    assert(Math.abs(peak - 64) < 0.01, '64 oscillators on one normalized wave peak at 64');
+
+    // imag is the sine term, as in the spec
+    const sineCtx = new OfflineAudioContext({
+        numberOfChannels: 1,
+        length: 441,
+        sampleRate: 44100
+    });
+    const osc = sineCtx.createOscillator();
+    osc.setPeriodicWave(sineCtx.createPeriodicWave([0, 0], [0, 1], { disableNormalization: true }));
+    osc.frequency.value = 1000;
+    osc.connect(sineCtx.destination);
+    osc.start(0);
+    const sine = (await sineCtx.startRendering()).getChannelData(0);
+    let error = 0;
+    for (let i = 0; i < sine.length; i++) {
+        error = Math.max(error, Math.abs(sine[i] - Math.sin((2 * Math.PI * 1000 * i) / 44100)));
+    }
+    assert(error < 1e-3, 'imag[1] = 1 plays a sine');
+}
+
+// Test 39: AudioBufferSourceNode resamples for playbackRate, detune and loops
+console.log('\nTest 39: Resampling AudioBufferSourceNode');
+{
+    const play = async (channelData, setup, length = 300) => {
+        const ctx = new OfflineAudioContext({ numberOfChannels: 1, length, sampleRate: 44100 });
+        const buffer = ctx.createBuffer(1, channelData.length, 44100);
+        buffer.getChannelData(0).set(channelData);
+        const source = ctx.createBufferSource();
+        source.buffer = buffer;
+        setup(source);
+        source.connect(ctx.destination);
+        source.start(0);
+        return (await ctx.startRendering()).getChannelData(0);
+    };
+    const maxError = (data, expected, from = 0) => {
+        let error = 0;
+        for (let i = from; i < data.length; i++) {
+            error = Math.max(error, Math.abs(data[i] - expected(i)));
+        }
+        return error;
+    };
+    const ramp = Float32Array.from({ length: 1000 }, (_, i) => i);
+
+    const half = await play(ramp, source => (source.playbackRate.value = 0.5));
+    assert(maxError(half, i => i / 2) < 1e-3, 'playbackRate 0.5 plays at half speed');
+
+    const octave = await play(ramp, source => (source.detune.value = 1200), 600);
+    assert(maxError(octave.subarray(0, 500), i => 2 * i) < 1e-2, 'detune +1200 plays an octave up');
+    assert(maxError(octave.subarray(500), () => 0) === 0, 'silent after the end of the buffer');
+
+    const looped = await play(ramp, source => {
+        source.loop = true;
+        source.loopStart = 100 / 44100;
+        source.loopEnd = 110 / 44100;
+    });
+    assert(maxError(looped.subarray(110), i => 100 + (i % 10)) < 1e-2, 'loop region repeats');
+
+    const sine = Float32Array.from({ length: 4000 }, (_, i) =>
+        Math.sin((2 * Math.PI * 441 * i) / 44100)
+    );
+    for (const interpolation of ['linear', 'cubic', 'sinc']) {
+        const data = await play(sine, source => {
+            source.interpolation = interpolation;
+            source.playbackRate.value = 0.73;
+        });
+        const error = maxError(data, i => Math.sin((2 * Math.PI * 441 * 0.73 * i) / 44100), 10);
+        const tolerance = interpolation === 'linear' ? 2e-3 : 1e-4;
+        assert(error < tolerance, `${interpolation} interpolation tracks the resampled sine`);
+    }
+}
+
+// Test 40: Buffer sources and convolvers share one copy of a buffer's PCM
+console.log('\nTest 40: Shared Buffer Sample Store');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 300, sampleRate: 44100 });
+    const buffer = ctx.createBuffer(1, 1000, 44100);
+    buffer.getChannelData(0).set(Float32Array.from({ length: 1000 }, (_, i) => i));
+    for (let i = 0; i < 16; i++) {
+        const source = ctx.createBufferSource();
+        source.buffer = buffer;
+        source.connect(ctx.destination);
+        source.start(0);
+    }
+    const data = (await ctx.startRendering()).getChannelData(0);
+    let error = 0;
+    for (let i = 0; i < data.length; i++) error = Math.max(error, Math.abs(data[i] - 16 * i));
+    assert(error < 1e-2, '16 sources play the same registered buffer');
+}
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 2048, sampleRate: 44100 });
+    const impulse = ctx.createBuffer(1, 1, 44100);
+    impulse.getChannelData(0)[0] = 1;
+    const convolver = ctx.createConvolver();
+    convolver.buffer = impulse;
+    const source = ctx.createBufferSource();
+    source.buffer = impulse;
+    source.connect(convolver);
+    convolver.connect(ctx.destination);
+    source.start(0);
+    const data = (await ctx.startRendering()).getChannelData(0);
+    const sum = data.reduce((total, value) => total + value, 0);
+    assert(Math.abs(sum - 1) < 1e-3, 'convolver uses a buffer also playing in a source');
+}
+
+// Test 41: Released one-shot sources and the processors they alone fed are reclaimed
+console.log('\nTest 41: Reclaiming Released Nodes');
+{
+    const sampleRate = 8000;
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 512, sampleRate });
+    const sourceWithBuffer = (frames, value) => {
+        const buffer = ctx.createBuffer(1, frames, sampleRate);
+        buffer.getChannelData(0).fill(value);
+        const source = ctx.createBufferSource();
+        source.buffer = buffer;
+        return source;
+    };
+
+    // Ends at frame 100, in the first quantum
+    const short = sourceWithBuffer(100, 0.5);
+    const gain = ctx.createGain();
+    short.connect(gain);
+    gain.connect(ctx.destination);
+    // Plays for the whole render
+    const long = sourceWithBuffer(512, 0.25);
+    long.connect(ctx.destination);
+    short.start(0);
+    long.start(0);
+    for (const node of [short, gain, long]) ctx._engine.releaseNode(node._nodeId);
+
+    const output = new Float32Array(512);
+    await ctx.startStreaming(
+        (chunk, framesRendered) => {
+            output.set(chunk, framesRendered - chunk.length);
+            if (framesRendered !== 256) return;
+            // By now the short source and then the gain it fed are gone: a
+            // source connected to the gain's stale handle must not be heard.
+            const probe = ctx.createConstantSource();
+            probe.connect(gain);
+            probe.start(0);
+            // A new buffer source takes a pooled kernel and starts out fresh
+            const reused = sourceWithBuffer(100, 0.5);
+            reused.connect(ctx.destination);
+            reused.start(384 / sampleRate);
+        },
+        { chunkFrames: 128 }
+    );
+
+    assertApprox(output[50], 0.75, 0.001, 'Both sources heard before the short one ends');
+    assertApprox(
+        output[300],
+        0.25,
+        0.001,
+        'Reclaimed gain is not brought back by a new connection'
+    );
+    assertApprox(output[434], 0.75, 0.001, 'Source created from the pool plays from the start');
+    assertApprox(output[511], 0.25, 0.001, 'Released source that is still playing keeps playing');
+}
+
+// Test 42: The worker renderer fills the shared ring from main-thread edits
+console.log('\nTest 42: Worker Render Engine');
+{
+    const engine = new WorkerRenderEngine(2, 8000, 0.1);
+    const destination = engine.createNode('destination');
+    const source = engine.createNode('constantSource');
+    engine.setNodeParameter(source, 'offset', 0.5);
+    engine.connectNodes(source, destination);
+    engine.startNode(source, 0);
+    engine.setProfiling(true);
+
+    // Stands in for the SDL device: keeps copies of what it is given
+    const chunks = [];
+    const device = {
+        enqueue: bytes => chunks.push(new Float32Array(Uint8Array.from(bytes).buffer))
+    };
+    const samples = () => chunks.reduce((total, chunk) => total + chunk.length, 0);
+
+    try {
+        await engine.start();
+        const frames = engine.enqueueRendered(device, 100);
+        assert(frames === 100 && samples() === 200, 'at most maxFrames are moved to the device');
+        const rest = engine.enqueueRendered(device, 8000);
+        assert(
+            rest > 0 && rest < 800 && samples() === (100 + rest) * 2,
+            `${rest} more frames, both channels`
+        );
+        const rendered = chunks.every(chunk => chunk.every(sample => sample === 0.5));
+        assert(rendered, 'ring carries the rendered audio');
+
+        const profile = await engine.getGraphProfile();
+        assert(
+            profile.nodes.some(node => node.id === source && node.type === 'constantSource'),
+            'worker maps main-thread node ids to its graph handles'
+        );
+
+        // The worker only renders as far ahead as the depth asked for
+        engine.setRingDepth(0.02);
+        engine.enqueueRendered(device, 8000);
+        await new Promise(resolve => setTimeout(resolve, 50));
+        const depth = engine.bufferedFrames;
+        assert(depth > 0 && depth <= 160, `worker refills the ring to its depth (${depth} frames)`);
+
+        // Once the destroy reaches the worker, silence follows the audio
+        // already in the ring
+        engine.destroyNode(source);
+        let silent = false;
+        for (let tries = 0; tries < 100 && !silent; tries++) {
+            await new Promise(resolve => setTimeout(resolve, 10));
+            chunks.length = 0;
+            engine.enqueueRendered(device, 8000);
+            silent = chunks.length > 0 && chunks[chunks.length - 1].at(-1) === 0;
+        }
+        assert(silent, 'node destroyed on the main thread stops in the worker');
+        const after = await engine.getGraphProfile();
+        assert(!after.nodes.some(node => node.id === source), 'destroyed node leaves the profile');
+
+        // Released and destroyed ids leave the worker's id map
+        const released = engine.createNode('gain');
+        engine.releaseNode(released);
+        const mapped = await engine.mappedNodeIds();
+        assert(
+            mapped.includes(destination) && !mapped.includes(source) && !mapped.includes(released),
+            'worker forgets ids the main thread has released or destroyed'
+        );
+    } finally {
+        engine.destroy();
+    }
+}
+
+// Test 43: Buffers edited after use are registered again with their new samples
+console.log('\nTest 43: Re-registering Edited Buffers');
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 256, sampleRate: 8000 });
+    const buffer = ctx.createBuffer(1, 256, 8000);
+    buffer.getChannelData(0).fill(0.25);
+    const first = ctx.createBufferSource();
+    first.buffer = buffer;
+    first.connect(ctx.destination);
+    first.start(0);
+
+    // The first source keeps the samples it was started with
+    buffer.getChannelData(0).fill(0.75);
+    const second = ctx.createBufferSource();
+    second.buffer = buffer;
+    second.connect(ctx.destination);
+    second.start(0);
+
+    // A released registration is forgotten and made again on next use
+    ctx._engine.releaseBuffer(buffer._id);
+    assert(!ctx._engine._registeredBuffers.has(buffer._id), 'released buffer is forgotten');
+    const third = ctx.createBufferSource();
+    third.buffer = buffer;
+    third.connect(ctx.destination);
+    third.start(0);
+
+    // Reading samples leaves the registration alone
+    const version = buffer._version;
+    buffer.getChannelData(0);
+    buffer._registerWith(ctx);
+    assert(buffer._version === version, 'reading channel data does not re-register');
+
+    const data = (await ctx.startRendering()).getChannelData(0);
+    assertApprox(data[100], 1.75, 0.001, 'each source plays the samples it was started with');
+}
+{
+    const ctx = new OfflineAudioContext({ numberOfChannels: 1, length: 2048, sampleRate: 8000 });
+    const impulse = ctx.createBuffer(1, 1, 8000);
+    impulse.getChannelData(0)[0] = 1;
+    const ir = ctx.createBuffer(1, 1, 8000);
+    ir.getChannelData(0)[0] = 1;
+
+    const convolver = ctx.createConvolver();
+    convolver.normalize = false;
+    convolver.buffer = ir;
+    ir.copyToChannel(Float32Array.of(0.5), 0);
+    convolver.buffer = ir;
+
+    const source = ctx.createBufferSource();
+    source.buffer = impulse;
+    source.connect(convolver);
+    convolver.connect(ctx.destination);
+    source.start(0);
+    const data = (await ctx.startRendering()).getChannelData(0);
+    const sum = data.reduce((total, value) => total + value, 0);
+    assertApprox(sum, 0.5, 0.001, 'convolver uses the impulse response as of its last assignment');
+}
+
 // Summary
 console.log(`\n${'='.repeat(50)}`);
 console.log(`Test Results: ${passed} passed, ${failed} failed`);
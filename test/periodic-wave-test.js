@@ -1,4 +1,4 @@
-import { AudioContext } from '../src/javascript/index.js';
+import { AudioContext, OfflineAudioContext } from '../index.js';
 
 console.log('\n=== Testing PeriodicWave (Custom Waveforms) ===\n');
 
@@ -22,7 +22,6 @@ for (let i = 0; i < squareImag.length; i++) {
 
 const squareWave = context.createPeriodicWave(squareReal, squareImag);
 console.log('  Created PeriodicWave with', squareImag.length, 'coefficients');
-console.log('  Wavetable size:', squareWave.wavetable.length);
 
 const osc1 = context.createOscillator();
 osc1.setPeriodicWave(squareWave);
@@ -100,12 +99,37 @@ osc3.stop();
 
 // Test 4: Test disableNormalization option
 console.log('\nTest 4: Testing disableNormalization option');
+console.log('  Cosine harmonics all peak at phase 0, so the raw waveform peaks at their sum');
+
+const peakReal = new Float32Array([0, 1.0, 0.5, 0.3, 0, 0.2]);
+const peakImag = new Float32Array(peakReal.length);
+const coefficientSum = peakReal.reduce((sum, value) => sum + value, 0);
+
+async function renderPeak(disableNormalization) {
+    const offline = new OfflineAudioContext({
+        numberOfChannels: 1,
+        length: 4410,
+        sampleRate: 44100
+    });
+    const osc = offline.createOscillator();
+    osc.setPeriodicWave(offline.createPeriodicWave(peakReal, peakImag, { disableNormalization }));
+    osc.frequency.value = 220;
+    osc.connect(offline.destination);
+    osc.start(0);
+    const data = (await offline.startRendering()).getChannelData(0);
+    return data.reduce((peak, value) => Math.max(peak, Math.abs(value)), 0);
+}
 
-const wave1 = context.createPeriodicWave(organReal, organImag, { disableNormalization: false });
-const wave2 = context.createPeriodicWave(organReal, organImag, { disableNormalization: true });
-
-console.log('  Normalized wave max:', Math.max(...wave1.wavetable.map(Math.abs)).toFixed(4));
-console.log('  Unnormalized wave max:', Math.max(...wave2.wavetable.map(Math.abs)).toFixed(4));
+const normalizedPeak = await renderPeak(false);
+const unnormalizedPeak = await renderPeak(true);
+console.log(`  Normalized peak: ${normalizedPeak.toFixed(4)} (expected 1)`);
+console.log(
+    `  Unnormalized peak: ${unnormalizedPeak.toFixed(4)} (expected ${coefficientSum.toFixed(4)})`
+);
+if (Math.abs(normalizedPeak - 1) > 0.01 || Math.abs(unnormalizedPeak - coefficientSum) > 0.01) {
+    console.error('  ❌ Normalization does not match the coefficients');
+    process.exitCode = 1;
+}
 
 await context.suspend();
 await context.close();
@@ -114,6 +138,6 @@ console.log('\n✅ PeriodicWave test complete!');
 console.log('\nPeriodicWave features:');
 console.log('  ✓ Create custom waveforms from Fourier coefficients');
 console.log('  ✓ Real and imaginary parts support');
-console.log('  ✓ Automatic wavetable generation');
+console.log('  ✓ Native band-limited table synthesis, shared between oscillators');
 console.log('  ✓ Optional normalization');
 console.log('  ✓ Used with OscillatorNode.setPeriodicWave()');